@@ -29,6 +29,70 @@ static uint64_t UnsynchronizedArenaMR_BENCHMARK()
     return duration_cast<nanoseconds>(end - begin).count();
 }
 
+// Thousands of small arenas. Deallocation cost depends on finding the arena of a pointer.
+static uint64_t UnsynchronizedArenaMR_small_arenas_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 4'096);
+    std::pmr::map<int, int> v(&memory_resource);
+
+    steady_clock::time_point begin = steady_clock::now();
+
+    for (int i = 0; i < 10; ++i)
+    {
+        for (int j = 0; j < 100'000; ++j)
+        {
+            v.emplace(j, j);
+        }
+        v.clear();
+    }
+
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t UnsynchronizedArenaMR_aligned_small_arenas_BENCHMARK()
+{
+    arena_mr::ArenaOptions options;
+    options.aligned_arenas = true;
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 4'096, options);
+    std::pmr::map<int, int> v(&memory_resource);
+
+    steady_clock::time_point begin = steady_clock::now();
+
+    for (int i = 0; i < 10; ++i)
+    {
+        for (int j = 0; j < 100'000; ++j)
+        {
+            v.emplace(j, j);
+        }
+        v.clear();
+    }
+
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+// Same as above with size and layout known at compile time.
+static uint64_t BasicArenaMR_fixed_aligned_small_arenas_BENCHMARK()
+{
+    arena_mr::BasicArenaMR<arena_mr::FixedArenaSize<4'096>, arena_mr::AlignedLayout> memory_resource(10);
+    std::pmr::map<int, int> v(&memory_resource);
+
+    steady_clock::time_point begin = steady_clock::now();
+
+    for (int i = 0; i < 10; ++i)
+    {
+        for (int j = 0; j < 100'000; ++j)
+        {
+            v.emplace(j, j);
+        }
+        v.clear();
+    }
+
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
 static uint64_t new_delete_resource_BENCHMARK()
 {
     auto *memory_resource = std::pmr::new_delete_resource();
@@ -99,11 +163,17 @@ int main()
     const int avg_count = 10;
 
     auto UnsynchronizedArenaMR_avg_time = WarmAndRun(warm_count, avg_count, UnsynchronizedArenaMR_BENCHMARK);
+    auto UnsynchronizedArenaMR_small_arenas_avg_time = WarmAndRun(warm_count, avg_count, UnsynchronizedArenaMR_small_arenas_BENCHMARK);
+    auto UnsynchronizedArenaMR_aligned_small_arenas_avg_time = WarmAndRun(warm_count, avg_count, UnsynchronizedArenaMR_aligned_small_arenas_BENCHMARK);
+    auto BasicArenaMR_fixed_aligned_small_arenas_avg_time = WarmAndRun(warm_count, avg_count, BasicArenaMR_fixed_aligned_small_arenas_BENCHMARK);
     auto new_delete_resource_avg_time = WarmAndRun(warm_count, avg_count, new_delete_resource_BENCHMARK);
     auto unsynchronized_pool_resource_avg_time = WarmAndRun(warm_count, avg_count, unsynchronized_pool_resource_BENCHMARK);
     auto monotonic_buffer_resource_avg_time = WarmAndRun(warm_count, avg_count, monotonic_buffer_resource_BENCHMARK);
 
     std::cout << "UnsynchronizedArenaMR_BENCHMARK: " << UnsynchronizedArenaMR_avg_time << "[ns]" << std::endl;
+    std::cout << "UnsynchronizedArenaMR_small_arenas_BENCHMARK: " << UnsynchronizedArenaMR_small_arenas_avg_time << "[ns]" << std::endl;
+    std::cout << "UnsynchronizedArenaMR_aligned_small_arenas_BENCHMARK: " << UnsynchronizedArenaMR_aligned_small_arenas_avg_time << "[ns]" << std::endl;
+    std::cout << "BasicArenaMR_fixed_aligned_small_arenas_BENCHMARK: " << BasicArenaMR_fixed_aligned_small_arenas_avg_time << "[ns]" << std::endl;
     std::cout << "new_delete_resource_BENCHMARK: " << new_delete_resource_avg_time << "[ns]" << std::endl;
     std::cout << "unsynchronized_pool_resource_BENCHMARK: " << unsynchronized_pool_resource_avg_time << "[ns]" << std::endl;
     std::cout << "monotonic_buffer_resource_BENCHMARK: " << monotonic_buffer_resource_avg_time << "[ns]" << std::endl;
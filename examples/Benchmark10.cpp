@@ -0,0 +1,84 @@
+#include "ArenaMR/ArenaMR.hpp"
+#include "BenchmarkUtility.hpp"
+
+#include <chrono>
+#include <iostream>
+
+using namespace std::chrono;
+
+// Small objects mixed with 64 byte aligned SIMD buffers and page aligned I/O buffers. In the shared active arena
+// every over-aligned request pads the cursor, with `dedicated_alignment` they are packed in arenas of their own.
+
+using StatsArenaMR = arena_mr::BasicArenaMR<arena_mr::WithStats, arena_mr::ExtendedFeatures>;
+
+struct Result
+{
+    uint64_t time_ns;
+    std::size_t alignment_padding;
+    std::size_t peak_upstream_bytes;
+};
+
+static void AllocateMixed(StatsArenaMR &memory_resource)
+{
+    for (int i = 0; i < 100'000; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            (void)memory_resource.Allocate(32, alignof(std::max_align_t));
+        }
+
+        if (i % 4 == 0)
+            (void)memory_resource.Allocate(256, 64);
+
+        if (i % 64 == 0)
+            (void)memory_resource.Allocate(4'096, 4'096);
+    }
+}
+
+static Result Run(arena_mr::ArenaOptions const &options)
+{
+    StatsArenaMR memory_resource(10, 65'536, options);
+
+    steady_clock::time_point begin = steady_clock::now();
+    AllocateMixed(memory_resource);
+    steady_clock::time_point end = steady_clock::now();
+
+    auto stats = memory_resource.Stats();
+    return {static_cast<uint64_t>(duration_cast<nanoseconds>(end - begin).count()), stats.alignment_padding, stats.peak_upstream_bytes};
+}
+
+static Result shared_arena_BENCHMARK()
+{
+    return Run({});
+}
+
+static Result dedicated_alignment_BENCHMARK()
+{
+    arena_mr::ArenaOptions options;
+    options.dedicated_alignment = 4'096;
+    return Run(options);
+}
+
+template <typename Benchmark>
+static void Report(char const *name, Benchmark &&benchmark)
+{
+    const int warm_count = 3;
+    const int avg_count = 10;
+
+    Result result{};
+    auto avg_time = WarmAndRun(warm_count, avg_count, [&]
+                               {
+                                   result = benchmark();
+                                   return result.time_ns; });
+
+    std::cout << name << ": " << avg_time << "[ns], padding " << result.alignment_padding << " bytes, peak "
+              << result.peak_upstream_bytes << " bytes" << std::endl;
+}
+
+int main()
+{
+    SetThreadAffinity(7);
+
+    Report("shared_arena_BENCHMARK", shared_arena_BENCHMARK);
+    Report("dedicated_alignment_BENCHMARK", dedicated_alignment_BENCHMARK);
+}
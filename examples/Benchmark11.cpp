@@ -0,0 +1,81 @@
+#include "ArenaMR/ArenaMR.hpp"
+#include "BenchmarkUtility.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+// Counters allocated one after another and handed to different threads. Without padding they share a cache line
+// and every increment takes the line away from the other threads.
+
+using Counter = std::atomic<std::uint64_t>;
+
+static uint64_t Run(arena_mr::ArenaOptions const &options)
+{
+    auto num_of_threads = std::clamp(std::thread::hardware_concurrency(), 2u, 8u);
+
+    arena_mr::BasicArenaMR<arena_mr::ExtendedFeatures> memory_resource(1, 4'096, options);
+
+    std::vector<Counter *> counters;
+    for (unsigned i = 0; i < num_of_threads; ++i)
+    {
+        counters.push_back(new (memory_resource.Allocate(sizeof(Counter), alignof(Counter))) Counter(0));
+    }
+
+    steady_clock::time_point begin = steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (auto *counter : counters)
+    {
+        threads.emplace_back([counter]
+                             {
+                                 for (int i = 0; i < 10'000'000; ++i)
+                                 {
+                                     counter->fetch_add(1, std::memory_order_relaxed);
+                                 } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    steady_clock::time_point end = steady_clock::now();
+
+    for (auto *counter : counters)
+    {
+        counter->~Counter();
+        memory_resource.Deallocate(counter, sizeof(Counter), alignof(Counter));
+    }
+
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t packed_BENCHMARK()
+{
+    return Run({});
+}
+
+static uint64_t cache_line_padding_BENCHMARK()
+{
+    arena_mr::ArenaOptions options;
+    options.cache_line_padding = 64;
+    return Run(options);
+}
+
+int main()
+{
+    const int warm_count = 1;
+    const int avg_count = 5;
+
+    auto packed_avg_time = WarmAndRun(warm_count, avg_count, packed_BENCHMARK);
+    auto cache_line_padding_avg_time = WarmAndRun(warm_count, avg_count, cache_line_padding_BENCHMARK);
+
+    std::cout << "packed_BENCHMARK: " << packed_avg_time << "[ns]" << std::endl;
+    std::cout << "cache_line_padding_BENCHMARK: " << cache_line_padding_avg_time << "[ns]" << std::endl;
+}
@@ -0,0 +1,98 @@
+#include "ArenaMR/ArenaMR.hpp"
+#include "ArenaMR/SynchronizedArenaMR.hpp"
+#include "BenchmarkUtility.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+// Every thread uses the same memory resource with its own container.
+
+static void Work(std::pmr::memory_resource *memory_resource)
+{
+    std::pmr::map<int, int> v(memory_resource);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        for (int j = 0; j < 20'000; ++j)
+        {
+            v.emplace(j, j);
+        }
+        v.clear();
+    }
+}
+
+static uint64_t RunThreads(std::pmr::memory_resource *memory_resource, int num_of_threads)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(num_of_threads);
+
+    steady_clock::time_point begin = steady_clock::now();
+
+    for (int i = 0; i < num_of_threads; ++i)
+    {
+        threads.emplace_back(Work, memory_resource);
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t SynchronizedArenaMR_BENCHMARK(int num_of_threads)
+{
+    arena_mr::SynchronizedArenaMR memory_resource(10 * num_of_threads, 100'000); // tune your arena
+    return RunThreads(&memory_resource, num_of_threads);
+}
+
+static uint64_t locked_UnsynchronizedArenaMR_BENCHMARK(int num_of_threads)
+{
+    // The usual workaround for sharing an `UnsynchronizedArenaMR` between threads.
+    arena_mr::BasicArenaMR<arena_mr::MutexLock> memory_resource(10 * num_of_threads, 100'000);
+    return RunThreads(&memory_resource, num_of_threads);
+}
+
+static uint64_t new_delete_resource_BENCHMARK(int num_of_threads)
+{
+    return RunThreads(std::pmr::new_delete_resource(), num_of_threads);
+}
+
+static uint64_t synchronized_pool_resource_BENCHMARK(int num_of_threads)
+{
+    std::pmr::synchronized_pool_resource memory_resource(
+        std::pmr::pool_options{/*.max_blocks_per_chunk =*/30'000, /*.largest_required_pool_block =*/40},
+        std::pmr::new_delete_resource());
+    return RunThreads(&memory_resource, num_of_threads);
+}
+
+int main()
+{
+    const int warm_count = 3;
+    const int avg_count = 10;
+
+    for (int num_of_threads : {1, 2, 4, 8})
+    {
+        auto SynchronizedArenaMR_avg_time = WarmAndRun(warm_count, avg_count, [=]
+                                                       { return SynchronizedArenaMR_BENCHMARK(num_of_threads); });
+        auto locked_UnsynchronizedArenaMR_avg_time = WarmAndRun(warm_count, avg_count, [=]
+                                                                { return locked_UnsynchronizedArenaMR_BENCHMARK(num_of_threads); });
+        auto new_delete_resource_avg_time = WarmAndRun(warm_count, avg_count, [=]
+                                                       { return new_delete_resource_BENCHMARK(num_of_threads); });
+        auto synchronized_pool_resource_avg_time = WarmAndRun(warm_count, avg_count, [=]
+                                                              { return synchronized_pool_resource_BENCHMARK(num_of_threads); });
+
+        std::cout << "Threads: " << num_of_threads << std::endl;
+        std::cout << "  SynchronizedArenaMR_BENCHMARK: " << SynchronizedArenaMR_avg_time << "[ns]" << std::endl;
+        std::cout << "  locked_UnsynchronizedArenaMR_BENCHMARK: " << locked_UnsynchronizedArenaMR_avg_time << "[ns]" << std::endl;
+        std::cout << "  new_delete_resource_BENCHMARK: " << new_delete_resource_avg_time << "[ns]" << std::endl;
+        std::cout << "  synchronized_pool_resource_BENCHMARK: " << synchronized_pool_resource_avg_time << "[ns]" << std::endl;
+    }
+}
@@ -0,0 +1,102 @@
+#include "ArenaMR/ArenaMR.hpp"
+#include "ArenaMR/SizeClassArenaMR.hpp"
+#include "BenchmarkUtility.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+
+using namespace std::chrono;
+
+// Mixed lifetimes. Half of the nodes survive every round, so arenas rarely become completely free.
+static void Churn(std::pmr::memory_resource *memory_resource)
+{
+    std::mt19937 random_engine(42);
+    std::pmr::map<int, int> v(memory_resource);
+
+    for (int j = 0; j < 20'000; ++j)
+    {
+        v.emplace(j, j);
+    }
+
+    for (int i = 0; i < 20; ++i)
+    {
+        for (int j = 0; j < 10'000; ++j)
+        {
+            v.erase(static_cast<int>(random_engine() % 40'000));
+        }
+        for (int j = 0; j < 10'000; ++j)
+        {
+            auto key = static_cast<int>(random_engine() % 40'000);
+            v.emplace(key, key);
+        }
+    }
+}
+
+static std::size_t arena_count = 0;
+
+static uint64_t UnsynchronizedArenaMR_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 16'384); // tune your arena
+
+    steady_clock::time_point begin = steady_clock::now();
+    Churn(&memory_resource);
+    steady_clock::time_point end = steady_clock::now();
+
+    arena_count = memory_resource.CurrentNumOfArenas();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t SizeClassArenaMR_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR arena_resource(10, 16'384);
+    arena_mr::SizeClassArenaMR memory_resource(&arena_resource, arena_mr::SizeClassOptions{/*.blocks_per_slab =*/128, /*.largest_size_class =*/256});
+
+    steady_clock::time_point begin = steady_clock::now();
+    Churn(&memory_resource);
+    steady_clock::time_point end = steady_clock::now();
+
+    arena_count = arena_resource.CurrentNumOfArenas();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t new_delete_resource_BENCHMARK()
+{
+    steady_clock::time_point begin = steady_clock::now();
+    Churn(std::pmr::new_delete_resource());
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t unsynchronized_pool_resource_BENCHMARK()
+{
+    std::pmr::unsynchronized_pool_resource memory_resource(
+        std::pmr::pool_options{/*.max_blocks_per_chunk =*/128, /*.largest_required_pool_block =*/256},
+        std::pmr::new_delete_resource());
+
+    steady_clock::time_point begin = steady_clock::now();
+    Churn(&memory_resource);
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+int main()
+{
+    SetThreadAffinity(7);
+
+    const int warm_count = 3;
+    const int avg_count = 10;
+
+    auto UnsynchronizedArenaMR_avg_time = WarmAndRun(warm_count, avg_count, UnsynchronizedArenaMR_BENCHMARK);
+    auto UnsynchronizedArenaMR_arena_count = arena_count;
+    auto SizeClassArenaMR_avg_time = WarmAndRun(warm_count, avg_count, SizeClassArenaMR_BENCHMARK);
+    auto SizeClassArenaMR_arena_count = arena_count;
+    auto new_delete_resource_avg_time = WarmAndRun(warm_count, avg_count, new_delete_resource_BENCHMARK);
+    auto unsynchronized_pool_resource_avg_time = WarmAndRun(warm_count, avg_count, unsynchronized_pool_resource_BENCHMARK);
+
+    std::cout << "UnsynchronizedArenaMR_BENCHMARK: " << UnsynchronizedArenaMR_avg_time << "[ns] " << UnsynchronizedArenaMR_arena_count << " arenas" << std::endl;
+    std::cout << "SizeClassArenaMR_BENCHMARK: " << SizeClassArenaMR_avg_time << "[ns] " << SizeClassArenaMR_arena_count << " arenas" << std::endl;
+    std::cout << "new_delete_resource_BENCHMARK: " << new_delete_resource_avg_time << "[ns]" << std::endl;
+    std::cout << "unsynchronized_pool_resource_BENCHMARK: " << unsynchronized_pool_resource_avg_time << "[ns]" << std::endl;
+}
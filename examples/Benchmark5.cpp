@@ -0,0 +1,91 @@
+#include "ArenaMR/ArenaMR.hpp"
+#include "BenchmarkUtility.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+
+using namespace std::chrono;
+
+// Request handlers which build a temporary map and throw it away.
+
+static void BuildMap(std::pmr::map<int, int> &v)
+{
+    for (int j = 0; j < 1'000; ++j)
+    {
+        v.emplace(j, j);
+    }
+}
+
+static uint64_t UnsynchronizedArenaMR_destroy_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 65'536);
+
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 1'000; ++i)
+    {
+        std::pmr::map<int, int> v(&memory_resource);
+        BuildMap(v);
+    }
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+// Nodes are not visited, the scope resets the cursors of the arenas.
+static uint64_t UnsynchronizedArenaMR_scope_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 65'536);
+
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 1'000; ++i)
+    {
+        arena_mr::ArenaScope scope(memory_resource);
+        auto *v = new (memory_resource.allocate(sizeof(std::pmr::map<int, int>))) std::pmr::map<int, int>(&memory_resource);
+        BuildMap(*v);
+    }
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t monotonic_buffer_resource_BENCHMARK()
+{
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 1'000; ++i)
+    {
+        std::pmr::monotonic_buffer_resource memory_resource(65'536);
+        auto *v = new (memory_resource.allocate(sizeof(std::pmr::map<int, int>))) std::pmr::map<int, int>(&memory_resource);
+        BuildMap(*v);
+    }
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t new_delete_resource_BENCHMARK()
+{
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 1'000; ++i)
+    {
+        std::pmr::map<int, int> v(std::pmr::new_delete_resource());
+        BuildMap(v);
+    }
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+int main()
+{
+    SetThreadAffinity(7);
+
+    const int warm_count = 3;
+    const int avg_count = 10;
+
+    auto UnsynchronizedArenaMR_destroy_avg_time = WarmAndRun(warm_count, avg_count, UnsynchronizedArenaMR_destroy_BENCHMARK);
+    auto UnsynchronizedArenaMR_scope_avg_time = WarmAndRun(warm_count, avg_count, UnsynchronizedArenaMR_scope_BENCHMARK);
+    auto monotonic_buffer_resource_avg_time = WarmAndRun(warm_count, avg_count, monotonic_buffer_resource_BENCHMARK);
+    auto new_delete_resource_avg_time = WarmAndRun(warm_count, avg_count, new_delete_resource_BENCHMARK);
+
+    std::cout << "UnsynchronizedArenaMR_destroy_BENCHMARK: " << UnsynchronizedArenaMR_destroy_avg_time << "[ns]" << std::endl;
+    std::cout << "UnsynchronizedArenaMR_scope_BENCHMARK: " << UnsynchronizedArenaMR_scope_avg_time << "[ns]" << std::endl;
+    std::cout << "monotonic_buffer_resource_BENCHMARK: " << monotonic_buffer_resource_avg_time << "[ns]" << std::endl;
+    std::cout << "new_delete_resource_BENCHMARK: " << new_delete_resource_avg_time << "[ns]" << std::endl;
+}
@@ -0,0 +1,113 @@
+#include "ArenaMR/ArenaAllocator.hpp"
+#include "ArenaMR/ArenaMR.hpp"
+#include "BenchmarkUtility.hpp"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <map>
+
+using namespace std::chrono;
+
+// The same containers on the same arena resource, once through the virtual calls of `polymorphic_allocator`
+// and once through `ArenaAllocator`.
+
+using AlignedArenaMR = arena_mr::BasicArenaMR<arena_mr::FixedArenaSize<65'536>, arena_mr::AlignedLayout>;
+
+template <typename Map>
+static uint64_t MapChurn(Map &v)
+{
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 10; ++i)
+    {
+        for (int j = 0; j < 100'000; ++j)
+        {
+            v.emplace(j, j);
+        }
+        v.clear();
+    }
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+template <typename List>
+static uint64_t ListChurn(List &v)
+{
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 10; ++i)
+    {
+        for (int j = 0; j < 100'000; ++j)
+        {
+            v.push_back(j);
+        }
+        v.clear();
+    }
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t polymorphic_allocator_map_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 100'000);
+    std::pmr::map<int, int> v(&memory_resource);
+    return MapChurn(v);
+}
+
+static uint64_t ArenaAllocator_map_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 100'000);
+    std::map<int, int, std::less<int>, arena_mr::ArenaAllocator<std::pair<int const, int>>> v(&memory_resource);
+    return MapChurn(v);
+}
+
+static uint64_t polymorphic_allocator_list_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 100'000);
+    std::pmr::list<int> v(&memory_resource);
+    return ListChurn(v);
+}
+
+static uint64_t ArenaAllocator_list_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 100'000);
+    std::list<int, arena_mr::ArenaAllocator<int>> v(&memory_resource);
+    return ListChurn(v);
+}
+
+// Arena capacity and the arena of a pointer are constants, the whole fast path is inlined.
+static uint64_t polymorphic_allocator_aligned_list_BENCHMARK()
+{
+    AlignedArenaMR memory_resource(10);
+    std::pmr::list<int> v(&memory_resource);
+    return ListChurn(v);
+}
+
+static uint64_t ArenaAllocator_aligned_list_BENCHMARK()
+{
+    AlignedArenaMR memory_resource(10);
+    std::list<int, arena_mr::ArenaAllocator<int, AlignedArenaMR>> v(&memory_resource);
+    return ListChurn(v);
+}
+
+int main()
+{
+    SetThreadAffinity(7);
+
+    const int warm_count = 3;
+    const int avg_count = 10;
+
+    auto polymorphic_allocator_map_avg_time = WarmAndRun(warm_count, avg_count, polymorphic_allocator_map_BENCHMARK);
+    auto ArenaAllocator_map_avg_time = WarmAndRun(warm_count, avg_count, ArenaAllocator_map_BENCHMARK);
+    auto polymorphic_allocator_list_avg_time = WarmAndRun(warm_count, avg_count, polymorphic_allocator_list_BENCHMARK);
+    auto ArenaAllocator_list_avg_time = WarmAndRun(warm_count, avg_count, ArenaAllocator_list_BENCHMARK);
+    auto polymorphic_allocator_aligned_list_avg_time = WarmAndRun(warm_count, avg_count, polymorphic_allocator_aligned_list_BENCHMARK);
+    auto ArenaAllocator_aligned_list_avg_time = WarmAndRun(warm_count, avg_count, ArenaAllocator_aligned_list_BENCHMARK);
+
+    std::cout << "polymorphic_allocator_map_BENCHMARK: " << polymorphic_allocator_map_avg_time << "[ns]" << std::endl;
+    std::cout << "ArenaAllocator_map_BENCHMARK: " << ArenaAllocator_map_avg_time << "[ns]" << std::endl;
+    std::cout << "polymorphic_allocator_list_BENCHMARK: " << polymorphic_allocator_list_avg_time << "[ns]" << std::endl;
+    std::cout << "ArenaAllocator_list_BENCHMARK: " << ArenaAllocator_list_avg_time << "[ns]" << std::endl;
+    std::cout << "polymorphic_allocator_aligned_list_BENCHMARK: " << polymorphic_allocator_aligned_list_avg_time << "[ns]" << std::endl;
+    std::cout << "ArenaAllocator_aligned_list_BENCHMARK: " << ArenaAllocator_aligned_list_avg_time << "[ns]" << std::endl;
+}
@@ -0,0 +1,117 @@
+#include "ArenaMR/ArenaCoroutine.hpp"
+#include "ArenaMR/ArenaMR.hpp"
+#include "BenchmarkUtility.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+using namespace std::chrono;
+
+// Request handlers as coroutines. Every request creates three short-lived frames.
+// Frames are allocated with global operator new, from an arena through `CoroutineArena` and from an arena given
+// as argument. Requires C++20.
+
+using Task = arena_mr::ArenaTask<int>;
+
+static Task Parse(int request)
+{
+    co_return request % 7;
+}
+
+static Task Compute(int request)
+{
+    co_return request * 3;
+}
+
+static Task HandleRequest(int request)
+{
+    auto parsed = co_await Parse(request);
+    auto computed = co_await Compute(request);
+    co_return parsed + computed;
+}
+
+static Task Parse(std::allocator_arg_t, arena_mr::UnsynchronizedArenaMR &, int request)
+{
+    co_return request % 7;
+}
+
+static Task Compute(std::allocator_arg_t, arena_mr::UnsynchronizedArenaMR &, int request)
+{
+    co_return request * 3;
+}
+
+// The resource is passed down explicitly
+static Task HandleRequest(std::allocator_arg_t, arena_mr::UnsynchronizedArenaMR &arena_resource, int request)
+{
+    auto parsed = co_await Parse(std::allocator_arg, arena_resource, request);
+    auto computed = co_await Compute(std::allocator_arg, arena_resource, request);
+    co_return parsed + computed;
+}
+
+static uint64_t operator_new_BENCHMARK()
+{
+    long long sum = 0;
+
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 1'000'000; ++i)
+    {
+        sum += HandleRequest(i).Get();
+    }
+    steady_clock::time_point end = steady_clock::now();
+
+    if (sum == 0)
+        std::cout << "unexpected sum" << std::endl;
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t CoroutineArena_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(4, 65'536);
+    arena_mr::CoroutineArena scope(memory_resource);
+    long long sum = 0;
+
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 1'000'000; ++i)
+    {
+        sum += HandleRequest(i).Get();
+    }
+    steady_clock::time_point end = steady_clock::now();
+
+    if (sum == 0)
+        std::cout << "unexpected sum" << std::endl;
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t allocator_arg_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(4, 65'536);
+    long long sum = 0;
+
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 1'000'000; ++i)
+    {
+        sum += HandleRequest(std::allocator_arg, memory_resource, i).Get();
+    }
+    steady_clock::time_point end = steady_clock::now();
+
+    if (sum == 0)
+        std::cout << "unexpected sum" << std::endl;
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+int main()
+{
+    SetThreadAffinity(7);
+
+    const int warm_count = 3;
+    const int avg_count = 10;
+
+    auto operator_new_avg_time = WarmAndRun(warm_count, avg_count, operator_new_BENCHMARK);
+    auto CoroutineArena_avg_time = WarmAndRun(warm_count, avg_count, CoroutineArena_BENCHMARK);
+    auto allocator_arg_avg_time = WarmAndRun(warm_count, avg_count, allocator_arg_BENCHMARK);
+
+    std::cout << "operator_new_BENCHMARK: " << operator_new_avg_time << "[ns]" << std::endl;
+    std::cout << "CoroutineArena_BENCHMARK: " << CoroutineArena_avg_time << "[ns]" << std::endl;
+    std::cout << "allocator_arg_BENCHMARK: " << allocator_arg_avg_time << "[ns]" << std::endl;
+}
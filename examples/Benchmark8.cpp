@@ -0,0 +1,102 @@
+#include "ArenaMR/ArenaMR.hpp"
+#include "BenchmarkUtility.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+
+using namespace std::chrono;
+
+// Every request builds a temporary map and adds a few entries to a cache which stays.
+// Without lifetime hints the cache nodes pin the arenas of the temporaries.
+
+using StatsArenaMR = arena_mr::BasicArenaMR<arena_mr::WithStats, arena_mr::ExtendedFeatures>;
+
+struct Result
+{
+    uint64_t time_ns;
+    std::size_t peak_upstream_bytes;
+    std::size_t num_of_arenas;
+};
+
+static void HandleRequests(std::pmr::memory_resource *temporary_resource, std::pmr::map<int, int> &cache)
+{
+    for (int i = 0; i < 2'000; ++i)
+    {
+        std::pmr::map<int, int> temporary(temporary_resource);
+        for (int j = 0; j < 500; ++j)
+        {
+            temporary.emplace(j, i);
+        }
+
+        for (int j = 0; j < 5; ++j)
+        {
+            cache.emplace(i * 5 + j, i);
+        }
+    }
+}
+
+static Result UnsynchronizedArenaMR_BENCHMARK()
+{
+    StatsArenaMR memory_resource(10, 65'536);
+    std::pmr::map<int, int> cache(&memory_resource);
+
+    steady_clock::time_point begin = steady_clock::now();
+    HandleRequests(&memory_resource, cache);
+    steady_clock::time_point end = steady_clock::now();
+
+    auto stats = memory_resource.Stats();
+    return {static_cast<uint64_t>(duration_cast<nanoseconds>(end - begin).count()), stats.peak_upstream_bytes, stats.num_of_arenas};
+}
+
+static Result UnsynchronizedArenaMR_lifetime_BENCHMARK()
+{
+    arena_mr::ArenaOptions options;
+    options.lifetime_classes = 2;
+    StatsArenaMR memory_resource(10, 65'536, options);
+    arena_mr::LifetimeResource long_lived(memory_resource, arena_mr::LONG_LIVED);
+    std::pmr::map<int, int> cache(&long_lived);
+
+    steady_clock::time_point begin = steady_clock::now();
+    HandleRequests(&memory_resource, cache);
+    steady_clock::time_point end = steady_clock::now();
+
+    auto stats = memory_resource.Stats();
+    return {static_cast<uint64_t>(duration_cast<nanoseconds>(end - begin).count()), stats.peak_upstream_bytes, stats.num_of_arenas};
+}
+
+static Result new_delete_resource_BENCHMARK()
+{
+    std::pmr::map<int, int> cache(std::pmr::new_delete_resource());
+
+    steady_clock::time_point begin = steady_clock::now();
+    HandleRequests(std::pmr::new_delete_resource(), cache);
+    steady_clock::time_point end = steady_clock::now();
+
+    return {static_cast<uint64_t>(duration_cast<nanoseconds>(end - begin).count()), 0, 0};
+}
+
+template <typename Benchmark>
+static void Run(char const *name, Benchmark &&benchmark)
+{
+    const int warm_count = 3;
+    const int avg_count = 10;
+
+    Result result{};
+    auto avg_time = WarmAndRun(warm_count, avg_count, [&]
+                               {
+                                   result = benchmark();
+                                   return result.time_ns; });
+
+    std::cout << name << ": " << avg_time << "[ns], peak " << result.peak_upstream_bytes << " bytes, "
+              << result.num_of_arenas << " arenas" << std::endl;
+}
+
+int main()
+{
+    SetThreadAffinity(7);
+
+    Run("UnsynchronizedArenaMR_BENCHMARK", UnsynchronizedArenaMR_BENCHMARK);
+    Run("UnsynchronizedArenaMR_lifetime_BENCHMARK", UnsynchronizedArenaMR_lifetime_BENCHMARK);
+    Run("new_delete_resource_BENCHMARK", new_delete_resource_BENCHMARK);
+}
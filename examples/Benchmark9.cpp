@@ -0,0 +1,160 @@
+#include "ArenaMR/ArenaMR.hpp"
+#include "ArenaMR/ArenaNodePool.hpp"
+#include "BenchmarkUtility.hpp"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <map>
+#include <vector>
+
+using namespace std::chrono;
+
+// Bulk loads: one call per node against `AllocateBatch` and `DeallocateBatch`, and node-based containers
+// on the arena resource directly against `ArenaNodePool`.
+
+using LockedArenaMR = arena_mr::BasicArenaMR<arena_mr::MutexLock>;
+
+static constexpr std::size_t NUM_OF_NODES = 100'000;
+static constexpr std::size_t NODE_SIZE = 48;
+
+static uint64_t Allocate_loop_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 100'000);
+    std::vector<void *> nodes(NUM_OF_NODES);
+
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 10; ++i)
+    {
+        for (auto &node : nodes)
+        {
+            node = memory_resource.allocate(NODE_SIZE);
+        }
+        for (auto *node : nodes)
+        {
+            memory_resource.deallocate(node, NODE_SIZE);
+        }
+    }
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t AllocateBatch_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 100'000);
+    std::vector<void *> nodes(NUM_OF_NODES);
+
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 10; ++i)
+    {
+        memory_resource.AllocateBatch(nodes.size(), NODE_SIZE, alignof(std::max_align_t), nodes.data());
+        memory_resource.DeallocateBatch(nodes.size(), NODE_SIZE, alignof(std::max_align_t), nodes.data());
+    }
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+template <typename Map>
+static uint64_t MapLoad(Map &v)
+{
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 10; ++i)
+    {
+        for (std::size_t j = 0; j < NUM_OF_NODES; ++j)
+        {
+            v.emplace(j, j);
+        }
+        v.clear();
+    }
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+template <typename List>
+static uint64_t ListLoad(List &v)
+{
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < 10; ++i)
+    {
+        for (std::size_t j = 0; j < NUM_OF_NODES; ++j)
+        {
+            v.push_back(j);
+        }
+        v.clear();
+    }
+    steady_clock::time_point end = steady_clock::now();
+    return duration_cast<nanoseconds>(end - begin).count();
+}
+
+static uint64_t UnsynchronizedArenaMR_map_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 100'000);
+    std::pmr::map<std::size_t, std::size_t> v(&memory_resource);
+    return MapLoad(v);
+}
+
+static uint64_t ArenaNodePool_map_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 100'000);
+    arena_mr::ArenaNodePool node_pool(&memory_resource);
+    std::pmr::map<std::size_t, std::size_t> v(&node_pool);
+    return MapLoad(v);
+}
+
+static uint64_t UnsynchronizedArenaMR_list_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 100'000);
+    std::pmr::list<std::size_t> v(&memory_resource);
+    return ListLoad(v);
+}
+
+static uint64_t ArenaNodePool_list_BENCHMARK()
+{
+    arena_mr::UnsynchronizedArenaMR memory_resource(10, 100'000);
+    arena_mr::ArenaNodePool node_pool(&memory_resource);
+    std::pmr::list<std::size_t> v(&node_pool);
+    return ListLoad(v);
+}
+
+// With a lock every call of the arena resource costs a lock and an unlock, the pool takes it once per batch.
+static uint64_t LockedArenaMR_list_BENCHMARK()
+{
+    LockedArenaMR memory_resource(10, 100'000);
+    std::pmr::list<std::size_t> v(&memory_resource);
+    return ListLoad(v);
+}
+
+static uint64_t ArenaNodePool_locked_list_BENCHMARK()
+{
+    LockedArenaMR memory_resource(10, 100'000);
+    arena_mr::ArenaNodePool<LockedArenaMR> node_pool(&memory_resource);
+    std::pmr::list<std::size_t> v(&node_pool);
+    return ListLoad(v);
+}
+
+int main()
+{
+    SetThreadAffinity(7);
+
+    const int warm_count = 3;
+    const int avg_count = 10;
+
+    auto Allocate_loop_avg_time = WarmAndRun(warm_count, avg_count, Allocate_loop_BENCHMARK);
+    auto AllocateBatch_avg_time = WarmAndRun(warm_count, avg_count, AllocateBatch_BENCHMARK);
+    auto UnsynchronizedArenaMR_map_avg_time = WarmAndRun(warm_count, avg_count, UnsynchronizedArenaMR_map_BENCHMARK);
+    auto ArenaNodePool_map_avg_time = WarmAndRun(warm_count, avg_count, ArenaNodePool_map_BENCHMARK);
+    auto UnsynchronizedArenaMR_list_avg_time = WarmAndRun(warm_count, avg_count, UnsynchronizedArenaMR_list_BENCHMARK);
+    auto ArenaNodePool_list_avg_time = WarmAndRun(warm_count, avg_count, ArenaNodePool_list_BENCHMARK);
+    auto LockedArenaMR_list_avg_time = WarmAndRun(warm_count, avg_count, LockedArenaMR_list_BENCHMARK);
+    auto ArenaNodePool_locked_list_avg_time = WarmAndRun(warm_count, avg_count, ArenaNodePool_locked_list_BENCHMARK);
+
+    std::cout << "Allocate_loop_BENCHMARK: " << Allocate_loop_avg_time << "[ns]" << std::endl;
+    std::cout << "AllocateBatch_BENCHMARK: " << AllocateBatch_avg_time << "[ns]" << std::endl;
+    std::cout << "UnsynchronizedArenaMR_map_BENCHMARK: " << UnsynchronizedArenaMR_map_avg_time << "[ns]" << std::endl;
+    std::cout << "ArenaNodePool_map_BENCHMARK: " << ArenaNodePool_map_avg_time << "[ns]" << std::endl;
+    std::cout << "UnsynchronizedArenaMR_list_BENCHMARK: " << UnsynchronizedArenaMR_list_avg_time << "[ns]" << std::endl;
+    std::cout << "ArenaNodePool_list_BENCHMARK: " << ArenaNodePool_list_avg_time << "[ns]" << std::endl;
+    std::cout << "LockedArenaMR_list_BENCHMARK: " << LockedArenaMR_list_avg_time << "[ns]" << std::endl;
+    std::cout << "ArenaNodePool_locked_list_BENCHMARK: " << ArenaNodePool_locked_list_avg_time << "[ns]" << std::endl;
+}
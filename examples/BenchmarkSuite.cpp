@@ -0,0 +1,506 @@
+#include "ArenaMR/ArenaMR.hpp"
+#include "ArenaMR/SynchronizedArenaMR.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Parameterized benchmarks of arena configurations against the standard memory resources.
+//
+// Usage: BenchmarkSuite [--format=text|csv|json] [--output=FILE] [--iterations=N] [--workload=NAME]
+//
+// Every workload runs `iterations` times on a fresh resource. The upstream of every resource counts the
+// memory it hands out, so peak memory is comparable between the resources. One more run goes through
+// `LatencyResource`, which times every allocation for the latency percentiles. Its overhead stays out of the
+// iteration times.
+
+using namespace std::chrono;
+
+// Thread-safe upstream which counts the bytes it holds.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    std::size_t PeakBytes() const noexcept { return peak_bytes_; }
+    std::size_t NumOfAllocations() const noexcept { return num_of_allocations_; }
+
+protected:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        auto current = current_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        auto peak = peak_bytes_.load(std::memory_order_relaxed);
+        while (current > peak && !peak_bytes_.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+        {
+        }
+        num_of_allocations_.fetch_add(1, std::memory_order_relaxed);
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        current_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    std::atomic<std::size_t> current_bytes_ = 0;
+    std::atomic<std::size_t> peak_bytes_ = 0;
+    std::atomic<std::size_t> num_of_allocations_ = 0;
+};
+
+// Allocations of new_delete_resource bypass the upstream. Counted by wrapping the resource itself.
+class CountingNewDeleteResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingNewDeleteResource(CountingResource *counter) : counter_(counter) {}
+
+protected:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        return counter_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        counter_->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    CountingResource *counter_;
+};
+
+// Times every allocation of the wrapped resource, including one read of the clock and a virtual call.
+// Samples are recorded outside of the timed call.
+class LatencyResource : public std::pmr::memory_resource
+{
+public:
+    explicit LatencyResource(std::pmr::memory_resource *resource) : resource_(resource)
+    {
+        samples_.reserve(1 << 20);
+    }
+
+    std::vector<uint64_t> TakeSamples() noexcept { return std::move(samples_); }
+
+protected:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        steady_clock::time_point begin = steady_clock::now();
+        auto *p = resource_->allocate(bytes, alignment);
+        steady_clock::time_point end = steady_clock::now();
+
+        std::lock_guard lock(mutex_);
+        samples_.push_back(duration_cast<nanoseconds>(end - begin).count());
+        return p;
+    }
+
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        resource_->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    std::pmr::memory_resource *resource_;
+    std::mutex mutex_; // Producer/consumer workloads allocate from two threads
+    std::vector<uint64_t> samples_;
+};
+
+struct Workload
+{
+    std::string name;
+    bool multi_threaded;
+    std::function<std::size_t(std::pmr::memory_resource *)> run; // Returns the number of operations
+};
+
+struct ResourceConfig
+{
+    std::string name;
+    std::size_t num_of_arenas;
+    std::size_t size_per_arena;
+    bool thread_safe;
+    std::function<std::unique_ptr<std::pmr::memory_resource>(CountingResource *)> make;
+};
+
+struct Result
+{
+    std::string workload;
+    std::string resource;
+    std::size_t num_of_arenas;
+    std::size_t size_per_arena;
+    std::size_t iterations;
+    double mean_ns; // Per iteration
+    uint64_t allocate_p50_ns;
+    uint64_t allocate_p90_ns;
+    uint64_t allocate_p99_ns;
+    double ops_per_sec;
+    std::size_t peak_upstream_bytes;
+    std::size_t upstream_allocations;
+};
+
+static std::size_t NodeChurn(std::pmr::memory_resource *memory_resource)
+{
+    std::pmr::map<int, int> v(memory_resource);
+    for (int i = 0; i < 5; ++i)
+    {
+        for (int j = 0; j < 20'000; ++j)
+        {
+            v.emplace(j, j);
+        }
+        v.clear();
+    }
+    return 5 * 20'000;
+}
+
+static std::size_t VectorGrowth(std::pmr::memory_resource *memory_resource)
+{
+    std::size_t ops = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        std::pmr::vector<int> v(memory_resource);
+        for (int j = 0; j < 1'000; ++j)
+        {
+            v.push_back(j);
+        }
+        ops += v.size();
+    }
+    return ops;
+}
+
+static std::size_t StringMap(std::pmr::memory_resource *memory_resource)
+{
+    std::pmr::map<std::pmr::string, std::pmr::string> v(memory_resource);
+    for (int j = 0; j < 10'000; ++j)
+    {
+        auto key = std::to_string(j) + "_a_key_which_is_long_enough_to_allocate";
+        v.emplace(std::pmr::string(key, memory_resource), std::pmr::string(j % 64 + 16, 'x', memory_resource));
+    }
+    return 10'000;
+}
+
+static std::size_t MixedLifetimes(std::pmr::memory_resource *memory_resource)
+{
+    std::mt19937 random_engine(42);
+    std::pmr::map<int, int> v(memory_resource);
+    for (int i = 0; i < 50'000; ++i)
+    {
+        auto key = static_cast<int>(random_engine() % 20'000);
+        if (random_engine() % 2 == 0)
+            v.emplace(key, key);
+        else
+            v.erase(key);
+    }
+    return 50'000;
+}
+
+static std::size_t Oversized(std::pmr::memory_resource *memory_resource)
+{
+    std::pmr::list<std::pmr::vector<char>> v(memory_resource);
+    for (int i = 0; i < 200; ++i)
+    {
+        v.emplace_back(static_cast<std::size_t>(64 * 1024 + i * 1024), 'x');
+        if (v.size() > 8)
+            v.pop_front();
+    }
+    return 200;
+}
+
+// One thread builds maps, another destroys them.
+static std::size_t ProducerConsumer(std::pmr::memory_resource *memory_resource)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::unique_ptr<std::pmr::map<int, int>>> queue;
+    bool done = false;
+
+    std::thread consumer([&]
+                         {
+        while (true)
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [&] { return done || !queue.empty(); });
+            if (queue.empty())
+                return;
+            auto message = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+            message.reset();
+        } });
+
+    for (int i = 0; i < 200; ++i)
+    {
+        auto message = std::make_unique<std::pmr::map<int, int>>(memory_resource);
+        for (int j = 0; j < 200; ++j)
+        {
+            message->emplace(j, j);
+        }
+        std::lock_guard lock(mutex);
+        queue.push_back(std::move(message));
+        condition.notify_one();
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        done = true;
+    }
+    condition.notify_one();
+    consumer.join();
+    return 200 * 200;
+}
+
+static std::vector<Workload> Workloads()
+{
+    return {
+        {"node_churn", false, NodeChurn},
+        {"vector_growth", false, VectorGrowth},
+        {"string_map", false, StringMap},
+        {"mixed_lifetimes", false, MixedLifetimes},
+        {"oversized", false, Oversized},
+        {"producer_consumer", true, ProducerConsumer},
+    };
+}
+
+static std::vector<ResourceConfig> ResourceConfigs()
+{
+    std::vector<ResourceConfig> configs;
+
+    for (std::size_t num_of_arenas : {4, 16, 64})
+    {
+        for (std::size_t size_per_arena : {4'096, 65'536, 1'048'576})
+        {
+            configs.push_back({"UnsynchronizedArenaMR", num_of_arenas, size_per_arena, false, [=](CountingResource *upstream)
+                               { return std::make_unique<arena_mr::UnsynchronizedArenaMR>(num_of_arenas, size_per_arena, upstream); }});
+
+            configs.push_back({"UnsynchronizedArenaMR_aligned", num_of_arenas, size_per_arena, false, [=](CountingResource *upstream)
+                               {
+                                   arena_mr::ArenaOptions options;
+                                   options.aligned_arenas = true;
+                                   return std::make_unique<arena_mr::UnsynchronizedArenaMR>(num_of_arenas, size_per_arena, options, upstream);
+                               }});
+
+            configs.push_back({"UnsynchronizedArenaMR_adaptive", num_of_arenas, size_per_arena, false, [=](CountingResource *upstream)
+                               {
+                                   arena_mr::ArenaOptions options;
+                                   options.growth_factor = 2;
+                                   options.max_size_per_arena = 64 * size_per_arena;
+                                   options.size_tiers = true;
+                                   return std::make_unique<arena_mr::UnsynchronizedArenaMR>(num_of_arenas, size_per_arena, options, upstream);
+                               }});
+
+            configs.push_back({"UnsynchronizedArenaMR_tail_reuse", num_of_arenas, size_per_arena, false, [=](CountingResource *upstream)
+                               {
+                                   arena_mr::ArenaOptions options;
+                                   options.tail_reuse = 8;
+                                   return std::make_unique<arena_mr::BasicArenaMR<arena_mr::ExtendedFeatures>>(num_of_arenas, size_per_arena, options, upstream);
+                               }});
+
+            configs.push_back({"UnsynchronizedArenaMR_lazy", num_of_arenas, size_per_arena, false, [=](CountingResource *upstream)
+                               {
+                                   arena_mr::ArenaOptions options;
+                                   options.lazy_arenas = true;
+                                   return std::make_unique<arena_mr::UnsynchronizedArenaMR>(num_of_arenas, size_per_arena, options, upstream);
+                               }});
+
+            // Only the thread which constructs the resource allocates in every workload, so other threads may free.
+            configs.push_back({"UnsynchronizedArenaMR_remote_free", num_of_arenas, size_per_arena, true, [=](CountingResource *upstream)
+                               { return std::make_unique<arena_mr::BasicArenaMR<arena_mr::RemoteFreeQueue>>(num_of_arenas, size_per_arena, upstream); }});
+
+            configs.push_back({"SynchronizedArenaMR", num_of_arenas, size_per_arena, true, [=](CountingResource *upstream)
+                               { return std::make_unique<arena_mr::SynchronizedArenaMR>(num_of_arenas, size_per_arena, upstream); }});
+        }
+    }
+
+    configs.push_back({"new_delete_resource", 0, 0, true, [](CountingResource *upstream)
+                       { return std::make_unique<CountingNewDeleteResource>(upstream); }});
+    configs.push_back({"unsynchronized_pool_resource", 0, 0, false, [](CountingResource *upstream)
+                       { return std::make_unique<std::pmr::unsynchronized_pool_resource>(upstream); }});
+    configs.push_back({"synchronized_pool_resource", 0, 0, true, [](CountingResource *upstream)
+                       { return std::make_unique<std::pmr::synchronized_pool_resource>(upstream); }});
+    configs.push_back({"monotonic_buffer_resource", 0, 0, false, [](CountingResource *upstream)
+                       { return std::make_unique<std::pmr::monotonic_buffer_resource>(upstream); }});
+
+    return configs;
+}
+
+static uint64_t Percentile(std::vector<uint64_t> const &sorted, double percentile)
+{
+    auto index = static_cast<std::size_t>(percentile * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+static Result Run(Workload const &workload, ResourceConfig const &config, std::size_t iterations)
+{
+    std::vector<uint64_t> times;
+    std::size_t ops = 0;
+    std::size_t peak_upstream_bytes = 0;
+    std::size_t upstream_allocations = 0;
+
+    // One warm up iteration
+    for (std::size_t i = 0; i < iterations + 1; ++i)
+    {
+        CountingResource upstream;
+        uint64_t elapsed = 0;
+        {
+            auto memory_resource = config.make(&upstream);
+
+            steady_clock::time_point begin = steady_clock::now();
+            ops = workload.run(memory_resource.get());
+            steady_clock::time_point end = steady_clock::now();
+
+            elapsed = duration_cast<nanoseconds>(end - begin).count();
+        }
+
+        if (i == 0)
+            continue;
+
+        times.push_back(elapsed);
+        peak_upstream_bytes = std::max(peak_upstream_bytes, upstream.PeakBytes());
+        upstream_allocations = upstream.NumOfAllocations();
+    }
+
+    double mean_ns = 0;
+    for (auto time : times)
+    {
+        mean_ns += static_cast<double>(time) / times.size();
+    }
+
+    // Latency of single allocations
+    std::vector<uint64_t> latencies;
+    {
+        CountingResource upstream;
+        auto memory_resource = config.make(&upstream);
+        LatencyResource latency_resource(memory_resource.get());
+        workload.run(&latency_resource);
+        latencies = latency_resource.TakeSamples();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    if (latencies.empty())
+        latencies.push_back(0);
+
+    return {workload.name, config.name, config.num_of_arenas, config.size_per_arena, iterations, mean_ns,
+            Percentile(latencies, 0.5), Percentile(latencies, 0.9), Percentile(latencies, 0.99),
+            ops / (mean_ns / 1e9), peak_upstream_bytes, upstream_allocations};
+}
+
+static void WriteText(std::ostream &out, std::vector<Result> const &results)
+{
+    for (auto const &r : results)
+    {
+        out << r.workload << " " << r.resource;
+        if (r.size_per_arena != 0)
+            out << "(" << r.num_of_arenas << ", " << r.size_per_arena << ")";
+        out << ": iteration " << static_cast<uint64_t>(r.mean_ns) << "[ns], allocate p50 " << r.allocate_p50_ns
+            << "[ns] p90 " << r.allocate_p90_ns << "[ns] p99 " << r.allocate_p99_ns << "[ns], "
+            << static_cast<uint64_t>(r.ops_per_sec) << " ops/s, peak " << r.peak_upstream_bytes << " bytes, "
+            << r.upstream_allocations << " upstream allocations" << std::endl;
+    }
+}
+
+static void WriteCsv(std::ostream &out, std::vector<Result> const &results)
+{
+    out << "workload,resource,num_of_arenas,size_per_arena,iterations,mean_ns,allocate_p50_ns,allocate_p90_ns,allocate_p99_ns,ops_per_sec,peak_upstream_bytes,upstream_allocations" << std::endl;
+    for (auto const &r : results)
+    {
+        out << r.workload << "," << r.resource << "," << r.num_of_arenas << "," << r.size_per_arena << "," << r.iterations << ","
+            << r.mean_ns << "," << r.allocate_p50_ns << "," << r.allocate_p90_ns << "," << r.allocate_p99_ns << "," << r.ops_per_sec << ","
+            << r.peak_upstream_bytes << "," << r.upstream_allocations << std::endl;
+    }
+}
+
+static void WriteJson(std::ostream &out, std::vector<Result> const &results)
+{
+    out << "[" << std::endl;
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        auto const &r = results[i];
+        out << "  {\"workload\": \"" << r.workload << "\", \"resource\": \"" << r.resource
+            << "\", \"num_of_arenas\": " << r.num_of_arenas << ", \"size_per_arena\": " << r.size_per_arena
+            << ", \"iterations\": " << r.iterations << ", \"mean_ns\": " << r.mean_ns
+            << ", \"allocate_p50_ns\": " << r.allocate_p50_ns << ", \"allocate_p90_ns\": " << r.allocate_p90_ns
+            << ", \"allocate_p99_ns\": " << r.allocate_p99_ns
+            << ", \"ops_per_sec\": " << r.ops_per_sec << ", \"peak_upstream_bytes\": " << r.peak_upstream_bytes
+            << ", \"upstream_allocations\": " << r.upstream_allocations << "}" << (i + 1 == results.size() ? "" : ",") << std::endl;
+    }
+    out << "]" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::string format = "text";
+    std::string output;
+    std::string workload_filter;
+    std::size_t iterations = 10;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        auto value = arg.substr(arg.find('=') + 1);
+
+        if (arg.rfind("--format=", 0) == 0)
+            format = value;
+        else if (arg.rfind("--output=", 0) == 0)
+            output = value;
+        else if (arg.rfind("--iterations=", 0) == 0)
+            iterations = std::max<std::size_t>(1, std::stoul(value));
+        else if (arg.rfind("--workload=", 0) == 0)
+            workload_filter = value;
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--format=text|csv|json] [--output=FILE] [--iterations=N] [--workload=NAME]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+
+    for (auto const &workload : Workloads())
+    {
+        if (!workload_filter.empty() && workload.name != workload_filter)
+            continue;
+
+        for (auto const &config : ResourceConfigs())
+        {
+            if (workload.multi_threaded && !config.thread_safe)
+                continue;
+
+            results.push_back(Run(workload, config, iterations));
+        }
+    }
+
+    std::ofstream file;
+    if (!output.empty())
+        file.open(output);
+    std::ostream &out = output.empty() ? std::cout : file;
+
+    if (format == "csv")
+        WriteCsv(out, results);
+    else if (format == "json")
+        WriteJson(out, results);
+    else
+        WriteText(out, results);
+}
@@ -69,4 +69,7 @@ int main()
 
     std::cout << "Free arena size: " << arena_resource.FreeArenaSize() << std::endl;
     std::cout << "Used Memory " << arena_resource.UsedMemory() << std::endl;
+
+    std::cout << "Released bytes " << arena_resource.Trim(10) << std::endl;
+    std::cout << "Number of arenas " << arena_resource.CurrentNumOfArenas() << std::endl;
 }
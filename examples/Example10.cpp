@@ -0,0 +1,142 @@
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <iostream>
+
+#ifdef __linux__
+
+#include "ArenaMR/OffsetPtr.hpp"
+#include "ArenaMR/SharedSegment.hpp"
+
+#include <new>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// An ingest process builds its data in a shared segment, an analysis process attaches to it read-only and reads
+// the data in place. The segment is a file, so it also outlives both processes.
+
+struct Record
+{
+    int key;
+    double value;
+};
+
+struct Alert
+{
+    int key;
+    arena_mr::OffsetPtr<Alert> next; // Valid at any address
+};
+
+struct Catalog
+{
+    explicit Catalog(std::pmr::memory_resource *memory_resource)
+        : records(memory_resource)
+    {
+    }
+
+    std::pmr::vector<Record> records; // Raw pointers, valid at the creation address
+    arena_mr::OffsetPtr<Alert> alerts;
+};
+
+static char const SEGMENT_PATH[] = "/tmp/arena_mr_example10.segment";
+static constexpr std::size_t SEGMENT_SIZE = 64 * 1024 * 1024;
+static constexpr int NUM_OF_RECORDS = 100'000;
+
+// Same address in every process, so the pmr containers in the segment can be read. The kernel picks a free range
+// before the fork, and it stays reserved in both processes until the segment is mapped there.
+static void *ReserveAddress(std::size_t size)
+{
+    auto *p = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+static void Ingest(void *segment_address)
+{
+    munmap(segment_address, SEGMENT_SIZE);
+
+    arena_mr::SegmentOptions segment_options;
+    segment_options.address = segment_address;
+    arena_mr::SharedSegment segment(arena_mr::SegmentBacking::File, SEGMENT_PATH, SEGMENT_SIZE, segment_options);
+
+    // The segment does not reuse freed memory, so the lists of the arena resource live outside of it.
+    arena_mr::ArenaOptions options;
+    options.bookkeeping = std::pmr::new_delete_resource();
+    arena_mr::UnsynchronizedArenaMR arena_resource(4, 1024 * 1024, options, &segment);
+
+    auto *catalog = new (arena_resource.allocate(sizeof(Catalog), alignof(Catalog))) Catalog(&arena_resource);
+
+    // One large object instead of a reallocation per growth, each of which would be lost in the segment
+    catalog->records.reserve(NUM_OF_RECORDS);
+
+    for (int i = 0; i < NUM_OF_RECORDS; ++i)
+    {
+        catalog->records.push_back(Record{i, i * 0.5});
+
+        if (i % 10'000 == 0)
+            catalog->alerts = new (arena_resource.allocate(sizeof(Alert), alignof(Alert))) Alert{i, catalog->alerts};
+    }
+
+    segment.SetRoot(catalog);
+    segment.Sync();
+
+    std::cout << "Used " << segment.UsedBytes() << " bytes, lost " << segment.DeallocatedBytes() << " bytes" << std::endl;
+
+    // The catalog is not destroyed, it stays in the segment for the readers.
+}
+
+static void Analyze()
+{
+    arena_mr::SharedSegment segment(arena_mr::SegmentBacking::File, SEGMENT_PATH, arena_mr::SegmentAccess::ReadOnly);
+
+    auto const *catalog = segment.Root<Catalog const>();
+
+    double sum = 0;
+    for (auto const &record : catalog->records)
+    {
+        sum += record.value;
+    }
+
+    std::cout << "Records: " << catalog->records.size() << ", sum: " << sum << std::endl;
+
+    std::cout << "Alerts:";
+    for (auto *alert = catalog->alerts.Get(); alert != nullptr; alert = alert->next.Get())
+    {
+        std::cout << " " << alert->key;
+    }
+    std::cout << std::endl;
+}
+
+int main()
+{
+    auto *segment_address = ReserveAddress(SEGMENT_SIZE);
+    if (segment_address == nullptr)
+        return 1;
+
+    auto pid = fork();
+    if (pid == 0)
+    {
+        Ingest(segment_address);
+        return 0;
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    munmap(segment_address, SEGMENT_SIZE);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return 1;
+
+    Analyze();
+
+    arena_mr::SharedSegment::Remove(arena_mr::SegmentBacking::File, SEGMENT_PATH);
+    return 0;
+}
+
+#else
+
+int main()
+{
+    std::cout << "SharedSegment is only available on Linux" << std::endl;
+}
+
+#endif
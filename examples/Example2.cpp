@@ -0,0 +1,86 @@
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <memory_resource>
+#include <vector>
+
+// A growable buffer which grows in place when it is the most recent allocation of the arena.
+class GrowableBuffer
+{
+public:
+    explicit GrowableBuffer(arena_mr::UnsynchronizedArenaMR *arena_resource) : arena_resource_(arena_resource) {}
+
+    GrowableBuffer(GrowableBuffer const &) = delete;
+    GrowableBuffer &operator=(GrowableBuffer const &) = delete;
+
+    ~GrowableBuffer()
+    {
+        arena_resource_->deallocate(data_, capacity_);
+    }
+
+    void PushBack(int value)
+    {
+        if (size_ == capacity_ / sizeof(int))
+        {
+            auto new_capacity = capacity_ == 0 ? 16 * sizeof(int) : 2 * capacity_;
+
+            if (data_ != nullptr && arena_resource_->TryExtend(data_, capacity_, new_capacity))
+            {
+                ++num_of_extends_;
+            }
+            else
+            {
+                auto *new_data = static_cast<int *>(arena_resource_->allocate(new_capacity));
+                if (data_ != nullptr)
+                {
+                    std::memcpy(new_data, data_, size_ * sizeof(int));
+                    arena_resource_->deallocate(data_, capacity_);
+                }
+                data_ = new_data;
+                ++num_of_copies_;
+            }
+            capacity_ = new_capacity;
+        }
+        data_[size_++] = value;
+    }
+
+    std::size_t NumOfExtends() const noexcept { return num_of_extends_; }
+    std::size_t NumOfCopies() const noexcept { return num_of_copies_; }
+
+private:
+    arena_mr::UnsynchronizedArenaMR *arena_resource_;
+    int *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0; // In bytes
+    std::size_t num_of_extends_ = 0;
+    std::size_t num_of_copies_ = 0;
+};
+
+int main()
+{
+    arena_mr::UnsynchronizedArenaMR arena_resource(10, 100'000);
+
+    {
+        std::pmr::vector<int> x(&arena_resource);
+        for (int i = 0; i < 10'000; ++i)
+        {
+            x.push_back(i);
+        }
+        std::cout << "std::pmr::vector" << std::endl;
+        std::cout << "Wasted Memory " << arena_resource.WastedMemory() << std::endl;
+        std::cout << "Used Memory " << arena_resource.UsedMemory() << std::endl;
+    }
+
+    {
+        GrowableBuffer x(&arena_resource);
+        for (int i = 0; i < 10'000; ++i)
+        {
+            x.PushBack(i);
+        }
+        std::cout << "GrowableBuffer" << std::endl;
+        std::cout << "Wasted Memory " << arena_resource.WastedMemory() << std::endl;
+        std::cout << "Used Memory " << arena_resource.UsedMemory() << std::endl;
+        std::cout << "Grown in place " << x.NumOfExtends() << " times, copied " << x.NumOfCopies() << " times" << std::endl;
+    }
+}
@@ -0,0 +1,58 @@
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <iostream>
+#include <map>
+
+#ifdef __linux__
+
+#include "ArenaMR/MmapMemoryResource.hpp"
+
+#include <fstream>
+
+// Resident set size of the process in bytes
+static std::size_t ResidentMemory()
+{
+    std::size_t size = 0;
+    std::size_t resident = 0;
+    std::ifstream("/proc/self/statm") >> size >> resident;
+    return resident * arena_mr::MmapMemoryResource::PageSize();
+}
+
+int main()
+{
+    arena_mr::MmapOptions mmap_options;
+    mmap_options.huge_pages = arena_mr::HugePages::Transparent;
+    arena_mr::MmapMemoryResource mmap_resource(mmap_options);
+
+    // Aligned arenas are exactly one huge page. Otherwise the arena header needs one more page.
+    arena_mr::ArenaOptions options;
+    options.aligned_arenas = true;
+    options.decommit = &arena_mr::MmapMemoryResource::Decommit;
+    options.committed_free_arenas = 2;
+    arena_mr::UnsynchronizedArenaMR arena_resource(64, 2 * 1024 * 1024, options, &mmap_resource);
+
+    std::cout << "Resident Memory " << ResidentMemory() << std::endl;
+
+    {
+        std::pmr::map<int, int> x(&arena_resource);
+        for (int i = 0; i < 1'000'000; ++i)
+        {
+            x.emplace(i, i);
+        }
+        std::cout << "Resident Memory " << ResidentMemory() << std::endl;
+    }
+
+    // Arenas are still there but their pages are given back to the OS.
+    std::cout << "Free arena size: " << arena_resource.FreeArenaSize() << std::endl;
+    std::cout << "Decommitted arena size: " << arena_resource.DecommittedArenaSize() << std::endl;
+    std::cout << "Resident Memory " << ResidentMemory() << std::endl;
+}
+
+#else
+
+int main()
+{
+    std::cout << "MmapMemoryResource is only available on Linux" << std::endl;
+}
+
+#endif
@@ -0,0 +1,46 @@
+#define ARENA_MR_ENABLE_STATS 1
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <iostream>
+#include <map>
+#include <string>
+
+static void PrintStats(arena_mr::ArenaStats const &stats)
+{
+    std::cout << "live_bytes " << stats.live_bytes << std::endl;
+    std::cout << "peak_live_bytes " << stats.peak_live_bytes << std::endl;
+    std::cout << "alignment_padding " << stats.alignment_padding << std::endl;
+    std::cout << "tail_waste " << stats.tail_waste << std::endl;
+    std::cout << "num_of_arenas " << stats.num_of_arenas << std::endl;
+    std::cout << "upstream_bytes " << stats.upstream_bytes << std::endl;
+    std::cout << "peak_upstream_bytes " << stats.peak_upstream_bytes << std::endl;
+    std::cout << "upstream_allocations " << stats.upstream_allocations << std::endl;
+    std::cout << "large_object_allocations " << stats.large_object_allocations << std::endl;
+    std::cout << "allocations " << stats.allocations << std::endl;
+    std::cout << "deallocations " << stats.deallocations << std::endl;
+
+    for (std::size_t i = 0; i < stats.size_histogram.size(); ++i)
+    {
+        if (stats.size_histogram[i] != 0)
+        {
+            std::cout << "  <= " << (std::size_t{1} << i) << " bytes: " << stats.size_histogram[i] << std::endl;
+        }
+    }
+}
+
+int main()
+{
+    arena_mr::UnsynchronizedArenaMR arena_resource(10, 10'000);
+
+    {
+        std::pmr::map<std::string, std::pmr::string> x(&arena_resource);
+        for (int i = 0; i < 10'000; ++i)
+        {
+            x.emplace(std::to_string(i), std::string(i % 100, 'a'));
+        }
+        PrintStats(arena_resource.Stats());
+    }
+
+    std::cout << std::endl;
+    PrintStats(arena_resource.Stats());
+}
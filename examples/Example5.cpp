@@ -0,0 +1,71 @@
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory_resource>
+#include <string>
+
+// Per-request scratch memory. Everything allocated while handling a request is freed at once.
+static std::size_t HandleRequest(arena_mr::UnsynchronizedArenaMR &arena_resource, int request)
+{
+    arena_mr::ArenaScope scope(arena_resource);
+
+    // Never destroyed. The scope frees its nodes without visiting them.
+    auto *words = new (arena_resource.allocate(sizeof(std::pmr::map<int, std::pmr::string>)))
+        std::pmr::map<int, std::pmr::string>(&arena_resource);
+
+    for (int i = 0; i < 1'000; ++i)
+    {
+        words->emplace(i, std::pmr::string(std::to_string(request * i) + " is a long enough string", &arena_resource));
+    }
+    return words->size();
+}
+
+int main()
+{
+    arena_mr::UnsynchronizedArenaMR arena_resource(4, 65'536);
+
+    // Lives across requests. Allocating it from the arena would pin the arena retired by the next mark.
+    std::map<int, std::size_t> totals;
+
+    for (int request = 0; request < 5; ++request)
+    {
+        totals[request] = HandleRequest(arena_resource, request);
+        std::cout << "Request " << request << ": " << arena_resource.CurrentNumOfArenas() << " arenas, "
+                  << arena_resource.FreeArenaSize() << " free, Used Memory " << arena_resource.UsedMemory() << std::endl;
+    }
+
+    // Without a scope
+    auto mark = arena_resource.Mark();
+    for (int i = 0; i < 100; ++i)
+    {
+        (void)arena_resource.allocate(1'000);
+    }
+    std::cout << "Before RewindTo Used Memory " << arena_resource.UsedMemory() << std::endl;
+    arena_resource.RewindTo(mark);
+    std::cout << "After RewindTo Used Memory " << arena_resource.UsedMemory() << std::endl;
+
+    // Oversized objects allocated before the mark survive the rewind, those allocated after it are freed.
+    auto *before = static_cast<char *>(arena_resource.allocate(100'000));
+    mark = arena_resource.Mark();
+    (void)arena_resource.allocate(100'000);
+    arena_resource.RewindTo(mark);
+    std::memset(before, 0, 100'000);
+    std::cout << "After RewindTo large object bytes " << arena_resource.Fragmentation().large_object_bytes << std::endl;
+    arena_resource.deallocate(before, 100'000);
+
+    // Padded requests stay in the default class, so the mark covers them. Only 128 byte aligned ones are dedicated.
+    arena_mr::ArenaOptions options;
+    options.cache_line_padding = 64;
+    options.dedicated_alignment = 4'096;
+    arena_mr::BasicArenaMR<arena_mr::ExtendedFeatures> padded_resource(4, 65'536, options);
+
+    mark = padded_resource.Mark();
+    for (int i = 0; i < 100; ++i)
+    {
+        (void)padded_resource.allocate(24);
+    }
+    padded_resource.RewindTo(mark);
+    std::cout << "After RewindTo with cache line padding Used Memory " << padded_resource.UsedMemory() << std::endl;
+}
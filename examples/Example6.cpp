@@ -0,0 +1,71 @@
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// The main thread builds messages, the consumer thread destroys them.
+// Frees of the consumer are queued and drained by the main thread, no data is copied out of the arena.
+
+using Message = std::pmr::map<int, int>;
+
+int main()
+{
+    arena_mr::BasicArenaMR<arena_mr::RemoteFreeQueue, arena_mr::WithStats> arena_resource(10, 16'384);
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::unique_ptr<Message>> queue;
+    bool done = false;
+    long long sum = 0;
+
+    std::thread consumer([&]
+                         {
+        while (true)
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [&] { return done || !queue.empty(); });
+            if (queue.empty())
+                return;
+            auto message = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+
+            for (auto const &[key, value] : *message)
+            {
+                sum += value;
+            }
+            message.reset(); // Queued to the owner
+        } });
+
+    for (int i = 0; i < 1'000; ++i)
+    {
+        auto message = std::make_unique<Message>(&arena_resource);
+        for (int j = 0; j < 100; ++j)
+        {
+            message->emplace(j, i);
+        }
+
+        std::lock_guard lock(mutex);
+        queue.push_back(std::move(message));
+        condition.notify_one();
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        done = true;
+    }
+    condition.notify_one();
+    consumer.join();
+
+    arena_resource.Collect();
+
+    auto stats = arena_resource.Stats();
+    std::cout << "Sum " << sum << std::endl;
+    std::cout << "Remote frees " << stats.remote_frees << std::endl;
+    std::cout << "Arenas " << stats.num_of_arenas << ", free " << arena_resource.FreeArenaSize() << std::endl;
+}
@@ -0,0 +1,67 @@
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <iostream>
+#include <list>
+#include <memory_resource>
+
+// Finds out why memory grows. A few long-living nodes are mixed with short-living ones and pin whole arenas.
+
+static char const *StateName(arena_mr::ArenaState state)
+{
+    switch (state)
+    {
+    case arena_mr::ArenaState::Active:
+        return "active";
+    case arena_mr::ArenaState::Full:
+        return "full";
+    case arena_mr::ArenaState::Free:
+        return "free";
+    case arena_mr::ArenaState::Decommitted:
+        return "decommitted";
+    }
+    return "";
+}
+
+static void PrintReport(arena_mr::FragmentationReport const &report)
+{
+    std::cout << "Arenas " << report.num_of_arenas << ": " << report.active_arenas << " active, " << report.full_arenas << " full, "
+              << report.free_arenas << " free, " << report.decommitted_arenas << " decommitted" << std::endl;
+    std::cout << "Capacity " << report.capacity << ", used " << report.used_bytes << ", free " << report.free_bytes << std::endl;
+    std::cout << "Tail waste " << report.tail_waste << ", alignment padding " << report.alignment_padding << std::endl;
+    std::cout << "Pinned arenas " << report.pinned_arenas << " (" << report.pinned_bytes << " bytes) kept by "
+              << report.pinned_allocations << " allocations" << std::endl;
+    std::cout << "Large objects " << report.large_objects << " (" << report.large_object_bytes << " bytes)" << std::endl;
+}
+
+int main()
+{
+    arena_mr::UnsynchronizedArenaMR arena_resource(4, 4'096);
+
+    std::pmr::list<int> survivors(&arena_resource);
+    {
+        std::pmr::list<int> temporaries(&arena_resource);
+        for (int i = 0; i < 10'000; ++i)
+        {
+            if (i % 100 == 0)
+                survivors.push_back(i);
+            else
+                temporaries.push_back(i);
+        }
+    }
+
+    PrintReport(arena_resource.Fragmentation());
+
+    // Occupancy of the first arenas
+    auto snapshot = arena_resource.Snapshot();
+    for (std::size_t i = 0; i < snapshot.size() && i < 8; ++i)
+    {
+        auto const &arena = snapshot[i];
+        std::cout << "  arena " << arena.address << ": " << StateName(arena.state) << ", " << arena.num_of_allocation
+                  << " allocations, " << arena.capacity - arena.bytes_left << "/" << arena.capacity << " bytes" << std::endl;
+    }
+
+    // Pinned arenas are not free, so Trim cannot give them back.
+    arena_resource.Trim();
+    std::cout << "After Trim" << std::endl;
+    PrintReport(arena_resource.Fragmentation());
+}
@@ -0,0 +1,82 @@
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <new>
+
+// Two pipeline stages with their own resources. The parser builds a batch of records in its resource and detaches
+// the arenas behind it. The aggregator adopts them, reads the records in place and frees the whole batch at once.
+
+struct Record
+{
+    int key;
+    double value;
+    Record *next;
+};
+
+struct Batch
+{
+    Record *first = nullptr;
+    arena_mr::ArenaHandle arenas;
+};
+
+static Batch Parse(arena_mr::UnsynchronizedArenaMR &parser_resource, int batch_index)
+{
+    auto mark = parser_resource.Mark();
+
+    Batch batch;
+    for (int i = 0; i < 1'000; ++i)
+    {
+        batch.first = new (parser_resource.allocate(sizeof(Record), alignof(Record))) Record{i, batch_index * 0.5, batch.first};
+    }
+
+    batch.arenas = parser_resource.Detach(mark);
+    return batch;
+}
+
+int main()
+{
+    arena_mr::UnsynchronizedArenaMR parser_resource(4, 16'384);
+
+    // Adopted arenas go to the free list of the aggregator when their batch is freed. Keep a few of them.
+    arena_mr::ArenaOptions options;
+    options.max_free_arenas = 8;
+    arena_mr::UnsynchronizedArenaMR aggregator_resource(4, 16'384, options);
+
+    std::deque<Batch> queue;
+    for (int i = 0; i < 100; ++i)
+    {
+        queue.push_back(Parse(parser_resource, i));
+    }
+
+    double sum = 0;
+    while (!queue.empty())
+    {
+        arena_mr::ArenaScope scope(aggregator_resource);
+
+        auto batch = std::move(queue.front());
+        queue.pop_front();
+        aggregator_resource.Adopt(std::move(batch.arenas));
+
+        for (auto *record = batch.first; record != nullptr; record = record->next)
+        {
+            sum += record->value;
+        }
+        // Records are trivially destructible, the scope frees them.
+    }
+
+    std::cout << "Sum " << sum << std::endl;
+    std::cout << "Parser arenas " << parser_resource.CurrentNumOfArenas() << std::endl;
+    std::cout << "Aggregator arenas " << aggregator_resource.CurrentNumOfArenas() << ", free " << aggregator_resource.FreeArenaSize() << std::endl;
+
+    // Oversized objects allocated before the mark stay with the parser.
+    auto *header = static_cast<char *>(parser_resource.allocate(50'000));
+    auto mark = parser_resource.Mark();
+    (void)parser_resource.allocate(50'000);
+    {
+        auto handle = parser_resource.Detach(mark);
+    }
+    std::memset(header, 0, 50'000);
+    parser_resource.deallocate(header, 50'000);
+}
@@ -0,0 +1,65 @@
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <string>
+
+// A server with a memory budget. Above the soft limit new requests are rejected until the cache is cleared.
+// Requests which would grow the resource beyond the hard limit are served by the default resource.
+
+static std::atomic<bool> shed_load = false;
+
+// Called while the resource is locked. Only sets a flag.
+static void OnSoftLimit(void *context, [[maybe_unused]] std::size_t upstream_bytes)
+{
+    static_cast<std::atomic<bool> *>(context)->store(true);
+}
+
+int main()
+{
+    arena_mr::ArenaOptions options;
+    options.soft_limit = 1'000'000;
+    options.soft_limit_callback = OnSoftLimit;
+    options.soft_limit_context = &shed_load;
+    options.hard_limit = 2'000'000;
+    options.fallback = std::pmr::get_default_resource();
+
+    arena_mr::BasicArenaMR<arena_mr::WithStats, arena_mr::ExtendedFeatures> arena_resource(4, 65'536, options);
+
+    std::pmr::list<std::pmr::string> cache(&arena_resource);
+
+    std::size_t num_of_rejected = 0;
+    for (int i = 0; i < 100'000; ++i)
+    {
+        if (shed_load)
+        {
+            num_of_rejected += 1;
+
+            if (num_of_rejected % 1'000 == 0)
+            {
+                // Drop the cache and give the arenas back, so the callback is armed again.
+                cache.clear();
+                arena_resource.Trim();
+                shed_load = false;
+            }
+            continue;
+        }
+
+        cache.emplace_back("request payload which does not fit into the small string buffer #" + std::to_string(i));
+    }
+
+    // A burst which ignores the load shedding
+    for (int i = 0; i < 20'000; ++i)
+    {
+        cache.emplace_back("burst payload which does not fit into the small string buffer #" + std::to_string(i));
+    }
+
+    auto stats = arena_resource.Stats();
+    std::cout << "Rejected requests: " << num_of_rejected << std::endl;
+    std::cout << "Soft limit events: " << stats.soft_limit_events << std::endl;
+    std::cout << "Fallback allocations: " << stats.fallback_allocations << std::endl;
+    std::cout << "Peak upstream bytes: " << stats.peak_upstream_bytes << std::endl;
+
+    return 0;
+}
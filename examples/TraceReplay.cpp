@@ -0,0 +1,200 @@
+#include "ArenaMR/ArenaMR.hpp"
+#include "ArenaMR/TracingMemoryResource.hpp"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Replays an allocation trace against many arena configurations to pick the settings offline.
+//
+// Usage: TraceReplay [TRACE_FILE] [--format=text|csv]
+//
+// Record a trace by putting a `TracingMemoryResource` between the containers and their resource.
+// Without a trace file a sample trace is recorded to `arena_trace.bin` first.
+
+using namespace std::chrono;
+
+using StatsArenaMR = arena_mr::BasicArenaMR<arena_mr::WithStats>;
+
+struct ReplayOperation
+{
+    bool allocate;
+    std::size_t bytes;
+    std::uint32_t alignment;
+    std::size_t slot; // Dense index of the object
+};
+
+struct ReplayResult
+{
+    std::string resource;
+    std::size_t num_of_arenas;
+    std::size_t size_per_arena;
+    uint64_t time_ns;
+    std::size_t peak_upstream_bytes;
+    std::size_t average_waste; // Tail waste sampled during an untimed replay, like the other statistics
+    std::size_t upstream_allocations;
+};
+
+static void RecordSampleTrace(char const *path)
+{
+    arena_mr::TracingMemoryResource tracing_resource(path);
+
+    std::mt19937 random_engine(42);
+    std::pmr::map<int, std::pmr::string> v(&tracing_resource);
+    for (int i = 0; i < 50'000; ++i)
+    {
+        auto key = static_cast<int>(random_engine() % 10'000);
+        if (random_engine() % 3 == 0)
+            v.erase(key);
+        else
+            v.emplace(key, std::pmr::string(random_engine() % 100, 'x', &tracing_resource));
+    }
+}
+
+// Object ids are addresses which are reused after deallocation. Map them to dense slots once, before timing.
+static std::vector<ReplayOperation> Prepare(std::vector<arena_mr::TraceRecord> const &records, std::size_t &num_of_slots)
+{
+    std::vector<ReplayOperation> operations;
+    operations.reserve(records.size());
+
+    std::unordered_map<std::uint64_t, std::size_t> live_slots;
+    num_of_slots = 0;
+
+    for (auto const &record : records)
+    {
+        if (record.event == arena_mr::TraceEvent::Allocate)
+        {
+            live_slots[record.object_id] = num_of_slots;
+            operations.push_back({true, static_cast<std::size_t>(record.bytes), record.alignment, num_of_slots++});
+        }
+        else
+        {
+            auto it = live_slots.find(record.object_id);
+            if (it == live_slots.end())
+                continue; // Allocated before the recording started
+            operations.push_back({false, static_cast<std::size_t>(record.bytes), record.alignment, it->second});
+            live_slots.erase(it);
+        }
+    }
+    return operations;
+}
+
+template <typename ArenaResource>
+static void ApplyOperation(ArenaResource &memory_resource, std::vector<void *> &slots, ReplayOperation const &operation)
+{
+    if (operation.allocate)
+        slots[operation.slot] = memory_resource.allocate(operation.bytes, operation.alignment);
+    else
+        memory_resource.deallocate(slots[operation.slot], operation.bytes, operation.alignment);
+}
+
+static ReplayResult Replay(std::vector<ReplayOperation> const &operations, std::size_t num_of_slots, std::string const &name,
+                           std::size_t num_of_arenas, std::size_t size_per_arena, arena_mr::ArenaOptions const &options)
+{
+    std::vector<void *> slots(num_of_slots, nullptr);
+    arena_mr::UnsynchronizedArenaMR memory_resource(num_of_arenas, size_per_arena, options);
+
+    steady_clock::time_point begin = steady_clock::now();
+    for (auto const &operation : operations)
+    {
+        ApplyOperation(memory_resource, slots, operation);
+    }
+    steady_clock::time_point end = steady_clock::now();
+
+    // The replay is deterministic. Statistics are taken from a second, untimed replay, so counting and sampling
+    // do not slow down the timed one.
+    std::vector<void *> sampled_slots(num_of_slots, nullptr);
+    StatsArenaMR sampled_resource(num_of_arenas, size_per_arena, options);
+
+    std::size_t waste_sum = 0;
+    std::size_t num_of_samples = 0;
+
+    for (std::size_t i = 0; i < operations.size(); ++i)
+    {
+        ApplyOperation(sampled_resource, sampled_slots, operations[i]);
+
+        if (i % 1024 == 0)
+        {
+            waste_sum += sampled_resource.WastedMemory();
+            num_of_samples += 1;
+        }
+    }
+
+    auto stats = sampled_resource.Stats();
+    return {name, num_of_arenas, size_per_arena, static_cast<uint64_t>(duration_cast<nanoseconds>(end - begin).count()),
+            stats.peak_upstream_bytes, num_of_samples == 0 ? 0 : waste_sum / num_of_samples, stats.upstream_allocations};
+}
+
+int main(int argc, char **argv)
+{
+    std::string trace_path = "arena_trace.bin";
+    std::string format = "text";
+    bool has_trace = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.rfind("--format=", 0) == 0)
+        {
+            format = arg.substr(9);
+        }
+        else
+        {
+            trace_path = arg;
+            has_trace = true;
+        }
+    }
+
+    if (!has_trace)
+    {
+        RecordSampleTrace(trace_path.c_str());
+    }
+
+    auto records = arena_mr::ReadTrace(trace_path.c_str());
+    std::size_t num_of_slots = 0;
+    auto operations = Prepare(records, num_of_slots);
+
+    std::vector<ReplayResult> results;
+    for (std::size_t num_of_arenas : {4, 16, 64})
+    {
+        for (std::size_t size_per_arena : {4'096, 16'384, 65'536, 262'144, 1'048'576})
+        {
+            arena_mr::ArenaOptions options;
+            results.push_back(Replay(operations, num_of_slots, "UnsynchronizedArenaMR", num_of_arenas, size_per_arena, options));
+
+            options.aligned_arenas = true;
+            results.push_back(Replay(operations, num_of_slots, "UnsynchronizedArenaMR_aligned", num_of_arenas, size_per_arena, options));
+
+            options = {};
+            options.growth_factor = 2;
+            options.max_size_per_arena = 64 * size_per_arena;
+            options.size_tiers = true;
+            results.push_back(Replay(operations, num_of_slots, "UnsynchronizedArenaMR_adaptive", num_of_arenas, size_per_arena, options));
+        }
+    }
+
+    if (format == "csv")
+    {
+        std::cout << "resource,num_of_arenas,size_per_arena,time_ns,peak_upstream_bytes,average_waste,upstream_allocations" << std::endl;
+        for (auto const &r : results)
+        {
+            std::cout << r.resource << "," << r.num_of_arenas << "," << r.size_per_arena << "," << r.time_ns << ","
+                      << r.peak_upstream_bytes << "," << r.average_waste << "," << r.upstream_allocations << std::endl;
+        }
+        return 0;
+    }
+
+    std::cout << records.size() << " records" << std::endl;
+    for (auto const &r : results)
+    {
+        std::cout << r.resource << "(" << r.num_of_arenas << ", " << r.size_per_arena << "): " << r.time_ns << "[ns], peak "
+                  << r.peak_upstream_bytes << " bytes, waste " << r.average_waste << " bytes, "
+                  << r.upstream_allocations << " upstream allocations" << std::endl;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef ARENA_ALLOCATOR
+#define ARENA_ALLOCATOR
+
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+namespace arena_mr
+{
+    /*
+        An allocator which calls the concrete arena resource directly instead of through `std::pmr::memory_resource`.
+
+        Allocation and deallocation are the same as with `std::pmr::polymorphic_allocator` on the same resource,
+        but the calls are not virtual, so the bump of the cursor is inlined into the container code.
+
+        * Not a pmr allocator. Nested containers do not get the allocator automatically, use
+          `std::scoped_allocator_adaptor` for that.
+        * The resource must outlive the containers, like with `polymorphic_allocator`.
+        * Propagates on copy, move and swap, two allocators are equal if they use the same resource.
+    */
+    template <typename T, typename ArenaResource = UnsynchronizedArenaMR>
+    class ArenaAllocator
+    {
+    public:
+        using value_type = T;
+
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = ArenaAllocator<U, ArenaResource>;
+        };
+
+        ArenaAllocator(ArenaResource *arena_resource) noexcept
+            : arena_resource_(arena_resource)
+        {
+            assert(arena_resource != nullptr);
+        }
+
+        template <typename U>
+        ArenaAllocator(ArenaAllocator<U, ArenaResource> const &other) noexcept
+            : arena_resource_(other.Resource())
+        {
+        }
+
+        T *allocate(std::size_t n)
+        {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                throw std::bad_array_new_length();
+
+            return static_cast<T *>(arena_resource_->Allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *p, std::size_t n) noexcept
+        {
+            arena_resource_->Deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        ArenaResource *Resource() const noexcept
+        {
+            return arena_resource_;
+        }
+
+    private:
+        ArenaResource *arena_resource_;
+    };
+
+    template <typename T, typename U, typename ArenaResource>
+    bool operator==(ArenaAllocator<T, ArenaResource> const &lhs, ArenaAllocator<U, ArenaResource> const &rhs) noexcept
+    {
+        return lhs.Resource() == rhs.Resource();
+    }
+
+    template <typename T, typename U, typename ArenaResource>
+    bool operator!=(ArenaAllocator<T, ArenaResource> const &lhs, ArenaAllocator<U, ArenaResource> const &rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+} // namespace arena_mr
+
+#endif // ARENA_ALLOCATOR
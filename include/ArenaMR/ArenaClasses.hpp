@@ -0,0 +1,224 @@
+#ifndef ARENA_CLASSES
+#define ARENA_CLASSES
+
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace arena_mr
+{
+    // Lifetime and alignment classes and tail reuse of `BasicArenaMR`, only used with `ExtendedFeatures`.
+
+    template <typename... Policies>
+    void *BasicArenaMR<Policies...>::AllocateFor(std::size_t lifetime, std::size_t bytes, std::size_t alignment)
+    {
+        static_assert(FeaturePolicy::EXTENDED, "Lifetime classes need ExtendedFeatures");
+        assert(lifetime < options_.lifetime_classes);
+
+        if (lifetime == 0)
+            return Allocate(bytes, alignment);
+
+        assert(!arena_info_map_.empty()); // Access to moved object
+
+        if (bytes == 0)
+            return nullptr;
+
+        std::lock_guard lock(mutex_);
+
+        PadRequest(bytes, alignment);
+
+        if constexpr (RemoteFreePolicy::ENABLED)
+        {
+            AdjustRequest(bytes, alignment);
+
+            if (remote_free_list_.load(std::memory_order_relaxed) != nullptr)
+            {
+                CollectRemoteFrees();
+            }
+        }
+
+        CountRequests(bytes, 1);
+
+        if (IsOversized(bytes, alignment))
+            return AllocateLargeObject(bytes, alignment);
+
+        ActiveClass active_class(*this, lifetime);
+        return DoAllocateDetails(bytes, alignment);
+    }
+
+    template <typename... Policies>
+    bool BasicArenaMR<Policies...>::PadRequest([[maybe_unused]] std::size_t &bytes, [[maybe_unused]] std::size_t &alignment) const noexcept
+    {
+        if constexpr (!FeaturePolicy::EXTENDED)
+            return false;
+
+        auto dedicated = IsDedicated(alignment);
+
+        if (options_.cache_line_padding != 0)
+        {
+            alignment = std::max(alignment, options_.cache_line_padding);
+            bytes = detail::AlignUp(bytes, options_.cache_line_padding);
+        }
+
+        if (dedicated)
+            bytes = detail::AlignUp(bytes, alignment);
+        return dedicated;
+    }
+
+    template <typename... Policies>
+    bool BasicArenaMR<Policies...>::IsDedicated(std::size_t alignment) const noexcept
+    {
+        return alignment > alignof(std::max_align_t) && alignment <= options_.dedicated_alignment;
+    }
+
+    template <typename... Policies>
+    std::size_t BasicArenaMR<Policies...>::AlignmentClass(std::size_t alignment) const noexcept
+    {
+        return options_.lifetime_classes + detail::BitWidth(alignment - 1) - detail::BitWidth(alignof(std::max_align_t));
+    }
+
+    template <typename... Policies>
+    std::size_t BasicArenaMR<Policies...>::NumOfClasses() const noexcept
+    {
+        return IsDedicated(options_.dedicated_alignment) ? AlignmentClass(options_.dedicated_alignment) + 1 : options_.lifetime_classes;
+    }
+
+    template <typename... Policies>
+    class BasicArenaMR<Policies...>::ActiveClass
+    {
+    public:
+        ActiveClass(BasicArenaMR &arena_resource, std::size_t arena_class) noexcept
+            : arena_resource_(arena_resource),
+              arena_class_(arena_class)
+        {
+            if (FeaturePolicy::EXTENDED && arena_class_ != 0)
+            {
+                std::swap(arena_resource_.active_arena_info_, arena_resource_.lifetime_arenas_[arena_class_ - 1]);
+                arena_resource_.current_lifetime_ = arena_class_;
+            }
+        }
+
+        ActiveClass(ActiveClass const &) = delete;
+        ActiveClass &operator=(ActiveClass const &) = delete;
+
+        ~ActiveClass()
+        {
+            if (FeaturePolicy::EXTENDED && arena_class_ != 0)
+            {
+                arena_resource_.current_lifetime_ = 0;
+                std::swap(arena_resource_.active_arena_info_, arena_resource_.lifetime_arenas_[arena_class_ - 1]);
+            }
+        }
+
+    private:
+        BasicArenaMR &arena_resource_;
+        std::size_t arena_class_;
+    };
+
+    template <typename... Policies>
+    void BasicArenaMR<Policies...>::KeepTail(ArenaInfo *arena) noexcept
+    {
+        if (arena->bytes_left < MIN_TAIL_SIZE)
+            return;
+
+        if (tail_arenas_.size() == options_.tail_reuse)
+        {
+            if (tail_arenas_.front()->bytes_left >= arena->bytes_left)
+                return;
+            tail_arenas_.erase(tail_arenas_.begin());
+        }
+
+        auto insert_it = std::upper_bound(tail_arenas_.begin(), tail_arenas_.end(), arena->bytes_left,
+                                          [](std::size_t bytes_left, ArenaInfo const *info)
+                                          { return bytes_left < info->bytes_left; });
+        tail_arenas_.insert(insert_it, arena);
+    }
+
+    template <typename... Policies>
+    void *BasicArenaMR<Policies...>::AllocateFromTail(std::size_t bytes, std::size_t alignment) noexcept
+    {
+        auto tail_it = std::lower_bound(tail_arenas_.begin(), tail_arenas_.end(), bytes,
+                                        [](ArenaInfo const *info, std::size_t bytes)
+                                        { return info->bytes_left < bytes; });
+
+        for (; tail_it != tail_arenas_.end(); ++tail_it)
+        {
+            auto *arena = *tail_it;
+            auto aligned_cursor = arena->AlignedCursor(alignment);
+            auto bytes_needed = ((std::byte *)aligned_cursor - arena->cursor) + bytes;
+
+            if (bytes_needed > arena->bytes_left)
+                continue;
+
+            arena->Reduce(bytes_needed);
+            CountAllocation(arena, bytes_needed, bytes);
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.tail_waste -= bytes_needed;
+                stats_.tail_allocations += 1;
+            }
+
+            // Keep the tails sorted
+            tail_arenas_.erase(tail_it);
+            KeepTail(arena);
+            return aligned_cursor;
+        }
+        return nullptr;
+    }
+
+    /*
+        A view of an arena resource which allocates from one lifetime class, see `ArenaOptions::lifetime_classes`.
+        Bind it to the containers whose objects stay, e.g. caches, so they do not pin the arenas of temporaries.
+
+        * Memory can be freed through the arena resource or any view of it, they compare equal.
+        * Does not own the arena resource.
+    */
+    template <typename ArenaResource = UnsynchronizedArenaMR>
+    class LifetimeResource : public std::pmr::memory_resource
+    {
+    public:
+        LifetimeResource(ArenaResource &arena_resource, std::size_t lifetime) noexcept
+            : arena_resource_(arena_resource),
+              lifetime_(lifetime)
+        {
+            assert(lifetime < arena_resource.Options().lifetime_classes);
+        }
+
+        ArenaResource &Resource() const noexcept
+        {
+            return arena_resource_;
+        }
+
+        std::size_t Lifetime() const noexcept
+        {
+            return lifetime_;
+        }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            return arena_resource_.AllocateFor(lifetime_, bytes, alignment);
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept override
+        {
+            arena_resource_.Deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+        {
+            if (auto *view = dynamic_cast<LifetimeResource const *>(&other))
+                return &view->arena_resource_ == &arena_resource_;
+            return &other == &arena_resource_;
+        }
+
+    private:
+        ArenaResource &arena_resource_;
+        std::size_t lifetime_;
+    };
+
+} // namespace arena_mr
+
+#endif // ARENA_CLASSES
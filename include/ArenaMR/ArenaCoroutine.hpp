@@ -0,0 +1,282 @@
+#ifndef ARENA_COROUTINE
+#define ARENA_COROUTINE
+
+#if __cplusplus < 202002L && (!defined(_MSVC_LANG) || _MSVC_LANG < 202002L)
+#error "ArenaCoroutine.hpp requires C++20"
+#endif
+
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace arena_mr
+{
+    // Frames of the coroutines started on this thread while the scope is alive are allocated from the resource,
+    // unless the coroutine gets a resource as argument. Scopes can be nested.
+    template <typename ArenaResource = UnsynchronizedArenaMR>
+    class CoroutineArena
+    {
+    public:
+        explicit CoroutineArena(ArenaResource &arena_resource) noexcept
+            : previous_(std::exchange(current_, &arena_resource))
+        {
+        }
+
+        CoroutineArena(CoroutineArena const &) = delete;
+        CoroutineArena &operator=(CoroutineArena const &) = delete;
+
+        ~CoroutineArena()
+        {
+            current_ = previous_;
+        }
+
+        // nullptr if there is no scope on this thread
+        static ArenaResource *Current() noexcept
+        {
+            return current_;
+        }
+
+    private:
+        static inline thread_local ArenaResource *current_ = nullptr;
+
+        ArenaResource *previous_;
+    };
+
+    /*
+        Base of a promise type which allocates the coroutine frame from an arena resource.
+
+        The resource is chosen when the coroutine is called:
+        * `std::allocator_arg, resource` as the first arguments (after the object for member functions)
+        * else the innermost `CoroutineArena` of the calling thread
+        * else global `operator new`
+
+        The resource is stored at the end of the frame, so the frame goes back to the resource it came from.
+        Frames are freed on the thread which destroys the coroutine, so with `UnsynchronizedArenaMR` coroutines
+        must be destroyed on the thread which owns the resource.
+
+        * Unoptimized GCC 12 builds report -Wmismatched-new-delete for coroutines which take a resource. It is a false
+          positive, every frame is freed by the usual `operator delete` which reads the resource from the frame.
+    */
+    template <typename ArenaResource = UnsynchronizedArenaMR>
+    struct ArenaPromise
+    {
+        static void *operator new(std::size_t size)
+        {
+            return AllocateFrame(size, CoroutineArena<ArenaResource>::Current());
+        }
+
+        template <typename... Args>
+        static void *operator new(std::size_t size, std::allocator_arg_t, ArenaResource &arena_resource, Args const &...)
+        {
+            return AllocateFrame(size, &arena_resource);
+        }
+
+        // Member coroutines get the object first
+        template <typename Object, typename... Args>
+        static void *operator new(std::size_t size, Object const &, std::allocator_arg_t, ArenaResource &arena_resource, Args const &...)
+        {
+            return AllocateFrame(size, &arena_resource);
+        }
+
+        static void operator delete(void *frame, std::size_t size) noexcept
+        {
+            auto *arena_resource = *ResourceSlot(frame, size);
+
+            if (arena_resource == nullptr)
+                ::operator delete(frame, FrameSize(size));
+            else
+                arena_resource->Deallocate(frame, FrameSize(size), alignof(std::max_align_t));
+        }
+
+    private:
+        static std::size_t FrameSize(std::size_t size) noexcept
+        {
+            return detail::AlignUp(size, alignof(ArenaResource *)) + sizeof(ArenaResource *);
+        }
+
+        static ArenaResource **ResourceSlot(void *frame, std::size_t size) noexcept
+        {
+            return reinterpret_cast<ArenaResource **>(static_cast<std::byte *>(frame) + detail::AlignUp(size, alignof(ArenaResource *)));
+        }
+
+        static void *AllocateFrame(std::size_t size, ArenaResource *arena_resource)
+        {
+            void *frame = arena_resource == nullptr
+                              ? ::operator new(FrameSize(size))
+                              : arena_resource->Allocate(FrameSize(size), alignof(std::max_align_t));
+
+            *ResourceSlot(frame, size) = arena_resource;
+            return frame;
+        }
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        struct TaskResult
+        {
+            template <typename U>
+            void return_value(U &&value)
+            {
+                result.emplace(std::forward<U>(value));
+            }
+
+            T TakeResult()
+            {
+                if (exception)
+                    std::rethrow_exception(exception);
+                return std::move(*result);
+            }
+
+            std::optional<T> result;
+            std::exception_ptr exception;
+        };
+
+        template <>
+        struct TaskResult<void>
+        {
+            void return_void() noexcept
+            {
+            }
+
+            void TakeResult()
+            {
+                if (exception)
+                    std::rethrow_exception(exception);
+            }
+
+            std::exception_ptr exception;
+        };
+    }
+
+    /*
+        A lazy task whose frame is allocated from an arena resource, see `ArenaPromise`.
+
+        The task starts when it is awaited or `Get` is called. A finished task resumes its awaiter directly.
+
+        * Move-only. The frame is destroyed with the task.
+    */
+    template <typename T = void, typename ArenaResource = UnsynchronizedArenaMR>
+    class [[nodiscard]] ArenaTask
+    {
+    public:
+        struct promise_type : ArenaPromise<ArenaResource>, detail::TaskResult<T>
+        {
+            ArenaTask get_return_object() noexcept
+            {
+                return ArenaTask(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept
+            {
+                return {};
+            }
+
+            auto final_suspend() noexcept
+            {
+                struct FinalAwaiter
+                {
+                    bool await_ready() noexcept
+                    {
+                        return false;
+                    }
+
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                    {
+                        auto continuation = handle.promise().continuation;
+                        return continuation ? continuation : std::noop_coroutine();
+                    }
+
+                    void await_resume() noexcept
+                    {
+                    }
+                };
+                return FinalAwaiter{};
+            }
+
+            void unhandled_exception() noexcept
+            {
+                this->exception = std::current_exception();
+            }
+
+            std::coroutine_handle<> continuation;
+        };
+
+        ArenaTask(ArenaTask &&other) noexcept
+            : handle_(std::exchange(other.handle_, nullptr))
+        {
+        }
+
+        ArenaTask &operator=(ArenaTask &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle_)
+                    handle_.destroy();
+                handle_ = std::exchange(other.handle_, nullptr);
+            }
+            return *this;
+        }
+
+        ~ArenaTask()
+        {
+            if (handle_)
+                handle_.destroy();
+        }
+
+        auto operator co_await() && noexcept
+        {
+            struct Awaiter
+            {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept
+                {
+                    handle.promise().continuation = awaiter;
+                    return handle;
+                }
+
+                T await_resume()
+                {
+                    return handle.promise().TakeResult();
+                }
+
+                std::coroutine_handle<promise_type> handle;
+            };
+
+            assert(handle_);
+            return Awaiter{handle_};
+        }
+
+        // Runs the task on the calling thread. Only for tasks which await nothing but other `ArenaTask`s,
+        // otherwise the task is not done when it suspends.
+        T Get()
+        {
+            assert(handle_ && !handle_.done());
+            handle_.resume();
+            assert(handle_.done());
+            return handle_.promise().TakeResult();
+        }
+
+    private:
+        explicit ArenaTask(std::coroutine_handle<promise_type> handle) noexcept
+            : handle_(handle)
+        {
+        }
+
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+} // namespace arena_mr
+
+#endif // ARENA_COROUTINE
@@ -0,0 +1,281 @@
+#ifndef ARENA_DETACH
+#define ARENA_DETACH
+
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace arena_mr
+{
+    /*
+        Arenas and large objects of a finished batch, detached from an arena resource with `Detach`.
+
+        Another resource takes them over with `Adopt`, otherwise they are given back to upstream by `Release`
+        or on destruction. The objects stay where they are, nothing is copied.
+
+        * Objects of the batch must not be deallocated while they are owned by the handle.
+        * Move-only.
+    */
+    class ArenaHandle
+    {
+    public:
+        ArenaHandle() = default;
+
+        ArenaHandle(ArenaHandle &&other) noexcept
+            : upstream_(std::exchange(other.upstream_, nullptr)),
+              size_per_arena_(other.size_per_arena_),
+              arena_alignment_(other.arena_alignment_),
+              arenas_(std::move(other.arenas_)),
+              large_object_list_(std::exchange(other.large_object_list_, nullptr)),
+              upstream_bytes_(std::exchange(other.upstream_bytes_, 0))
+        {
+        }
+
+        ArenaHandle &operator=(ArenaHandle &&other) noexcept
+        {
+            if (this != &other)
+            {
+                Release();
+                upstream_ = std::exchange(other.upstream_, nullptr);
+                size_per_arena_ = other.size_per_arena_;
+                arena_alignment_ = other.arena_alignment_;
+                arenas_ = std::move(other.arenas_);
+                other.arenas_.clear();
+                large_object_list_ = std::exchange(other.large_object_list_, nullptr);
+                upstream_bytes_ = std::exchange(other.upstream_bytes_, 0);
+            }
+            return *this;
+        }
+
+        ~ArenaHandle()
+        {
+            Release();
+        }
+
+        // Gives the arenas and the large objects back to upstream. Objects of the batch must not be used afterwards.
+        void Release() noexcept
+        {
+            for (auto *arena : arenas_)
+            {
+                auto arena_size = ARENA_HEADER_SIZE + arena->Capacity();
+                arena->~ArenaInfo();
+                upstream_->deallocate(arena, arena_size, arena_alignment_);
+            }
+            arenas_.clear();
+
+            while (large_object_list_ != nullptr)
+            {
+                auto *large_object = large_object_list_;
+                large_object_list_ = large_object->next;
+                upstream_->deallocate(large_object->block, large_object->block_size, large_object->block_alignment);
+            }
+
+            upstream_bytes_ = 0;
+        }
+
+        bool Empty() const noexcept
+        {
+            return arenas_.empty() && large_object_list_ == nullptr;
+        }
+
+        std::size_t NumOfArenas() const noexcept
+        {
+            return arenas_.size();
+        }
+
+        // Bytes held from upstream, arenas and large objects
+        std::size_t UpstreamBytes() const noexcept
+        {
+            return upstream_bytes_;
+        }
+
+    private:
+        template <typename... Policies>
+        friend class BasicArenaMR;
+
+        std::pmr::memory_resource *upstream_ = nullptr;
+        std::size_t size_per_arena_ = 0;
+        std::size_t arena_alignment_ = 0;
+
+        std::vector<ArenaInfo *> arenas_;
+        LargeObjectInfo *large_object_list_ = nullptr;
+        std::size_t upstream_bytes_ = 0;
+    };
+
+    template <typename... Policies>
+    ArenaHandle BasicArenaMR<Policies...>::Detach(ArenaMark const &mark)
+    {
+        static_assert(LargeObjectPolicy::TRACKED, "Forwarded large objects cannot be detached");
+
+        std::lock_guard lock(mutex_);
+
+        CollectRemoteFrees();
+
+        assert(mark.depth != 0 && mark.depth <= num_of_marks_); // Else the mark is already rewound
+        assert(mark.log_position <= activation_log_.size());
+
+        // Upstream cannot take back a part of the reservation.
+        for (auto i = mark.log_position; i < activation_log_.size(); ++i)
+        {
+            auto *arena = activation_log_[i];
+            if (arena != nullptr && arena->num_of_allocation != 0 && IsReserved(arena))
+                throw std::logic_error("Arenas of the lazy_arenas reservation cannot be detached");
+        }
+
+        ArenaHandle handle;
+        handle.upstream_ = upstream_;
+        handle.size_per_arena_ = SizePerArena();
+        handle.arena_alignment_ = ArenaAlignment();
+        handle.arenas_.reserve(activation_log_.size() - mark.log_position);
+
+        // The active arena is detached if it is used, a free one replaces it.
+        if (free_arena_list_.empty() && active_arena_info_->num_of_allocation != 0)
+        {
+            AddFreeArena();
+        }
+
+        // Nothing allocates from here on.
+
+        while (large_object_list_ != nullptr && large_object_list_->sequence >= mark.large_object_sequence)
+        {
+            auto *large_object = large_object_list_;
+            large_object_list_ = large_object->next;
+            if (large_object_list_ != nullptr)
+                large_object_list_->prev = nullptr;
+
+            large_object->next = handle.large_object_list_;
+            handle.large_object_list_ = large_object;
+            handle.upstream_bytes_ += large_object->block_size;
+
+            large_object_bytes_ -= large_object->bytes;
+            upstream_bytes_ -= large_object->block_size;
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.large_objects -= 1;
+                stats_.live_bytes -= large_object->bytes;
+            }
+        }
+
+        // Every arena in the log was empty when it was activated, so it only holds allocations made after the mark.
+        for (auto i = mark.log_position; i < activation_log_.size(); ++i)
+        {
+            auto *arena = activation_log_[i];
+
+            // Released, already detached or free because all of its allocations were freed
+            if (arena == nullptr || arena->num_of_allocation == 0)
+                continue;
+
+            upstream_bytes_ -= ARENA_HEADER_SIZE + arena->Capacity();
+
+            if constexpr (ENABLE_STATS)
+            {
+                if (arena != active_arena_info_)
+                {
+                    stats_.tail_waste -= arena->bytes_left;
+                }
+
+                stats_.alignment_padding -= arena->alignment_padding;
+                stats_.live_bytes -= arena->live_bytes;
+            }
+
+            handle.arenas_.push_back(arena);
+            handle.upstream_bytes_ += ARENA_HEADER_SIZE + arena->Capacity();
+            RemoveArena(arena);
+
+            if (arena == active_arena_info_)
+            {
+                active_arena_info_ = PopFreeArena();
+            }
+        }
+
+        num_of_marks_ = mark.depth - 1;
+        activation_log_.erase(activation_log_.begin() + mark.log_position, activation_log_.end());
+
+        // The active arena keeps serving the outer marks.
+        if (num_of_marks_ != 0)
+        {
+            // This cannot cause allocation, the log was longer before the erase.
+            activation_log_.push_back(active_arena_info_);
+        }
+
+        return handle;
+    }
+
+    template <typename... Policies>
+    void BasicArenaMR<Policies...>::Adopt(ArenaHandle &&handle)
+    {
+        static_assert(LargeObjectPolicy::TRACKED, "Forwarded large objects cannot be adopted");
+
+        std::lock_guard lock(mutex_);
+
+        if (handle.Empty())
+            return;
+
+        assert(handle.size_per_arena_ == SizePerArena() && handle.arena_alignment_ == ArenaAlignment());
+        assert(handle.upstream_->is_equal(*upstream_));
+
+        // Everything which may allocate comes first
+        arena_info_map_.reserve(arena_info_map_.size() + handle.arenas_.size());
+        free_arena_list_.reserve(arena_info_map_.size() + handle.arenas_.size());
+        if (num_of_marks_ != 0)
+        {
+            activation_log_.reserve(activation_log_.size() + handle.arenas_.size());
+        }
+
+        // Nothing allocates from here on.
+
+        for (auto *arena : handle.arenas_)
+        {
+            // Full arenas, their tails are wasted until they are free.
+            InsertArena(arena);
+
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.tail_waste += arena->bytes_left;
+                stats_.alignment_padding += arena->alignment_padding;
+                stats_.live_bytes += arena->live_bytes;
+            }
+
+            if (num_of_marks_ != 0)
+            {
+                activation_log_.push_back(arena);
+            }
+        }
+
+        while (handle.large_object_list_ != nullptr)
+        {
+            auto *large_object = handle.large_object_list_;
+            handle.large_object_list_ = large_object->next;
+
+            large_object->sequence = large_object_sequence_++;
+            large_object->prev = nullptr;
+            large_object->next = large_object_list_;
+            if (large_object_list_ != nullptr)
+                large_object_list_->prev = large_object;
+            large_object_list_ = large_object;
+
+            large_object_bytes_ += large_object->bytes;
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.large_objects += 1;
+                stats_.live_bytes += large_object->bytes;
+            }
+        }
+
+        upstream_bytes_ += handle.upstream_bytes_;
+        CheckSoftLimit();
+        if constexpr (ENABLE_STATS)
+        {
+            stats_.peak_upstream_bytes = std::max(stats_.peak_upstream_bytes, upstream_bytes_);
+            stats_.peak_live_bytes = std::max(stats_.peak_live_bytes, stats_.live_bytes);
+        }
+
+        handle.arenas_.clear();
+        handle.upstream_bytes_ = 0;
+    }
+
+} // namespace arena_mr
+
+#endif // ARENA_DETACH
@@ -0,0 +1,101 @@
+#ifndef ARENA_LIMITS
+#define ARENA_LIMITS
+
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <new>
+
+namespace arena_mr
+{
+    // Memory budget and fallback of `BasicArenaMR`, see `ArenaOptions::soft_limit` and `ArenaOptions::hard_limit`.
+
+    template <typename... Policies>
+    bool BasicArenaMR<Policies...>::FitsBudget(std::size_t bytes) const noexcept
+    {
+        return upstream_bytes_ <= options_.hard_limit && bytes <= options_.hard_limit - upstream_bytes_;
+    }
+
+    template <typename... Policies>
+    bool BasicArenaMR<Policies...>::MakeRoom(std::size_t bytes) noexcept
+    {
+        if (FitsBudget(bytes))
+            return true;
+
+        TrimLargeObjectCache();
+        return FitsBudget(bytes);
+    }
+
+    template <typename... Policies>
+    void BasicArenaMR<Policies...>::CheckSoftLimit() noexcept
+    {
+        if (!above_soft_limit_ && upstream_bytes_ > options_.soft_limit)
+        {
+            above_soft_limit_ = true;
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.soft_limit_events += 1;
+            }
+            if (options_.soft_limit_callback != nullptr)
+                options_.soft_limit_callback(options_.soft_limit_context, upstream_bytes_);
+        }
+    }
+
+    template <typename... Policies>
+    void *BasicArenaMR<Policies...>::AllocateFallback(std::size_t bytes, std::size_t alignment)
+    {
+        if (options_.fallback == nullptr)
+            throw std::bad_alloc();
+
+        auto *p = options_.fallback->allocate(bytes, alignment);
+        try
+        {
+            fallback_blocks_.emplace(p, FallbackBlock{bytes, alignment});
+        }
+        catch (...)
+        {
+            options_.fallback->deallocate(p, bytes, alignment);
+            throw;
+        }
+
+        if constexpr (ENABLE_STATS)
+        {
+            stats_.fallback_allocations += 1;
+            stats_.fallback_bytes += bytes;
+        }
+        return p;
+    }
+
+    template <typename... Policies>
+    bool BasicArenaMR<Policies...>::DeallocateFallback(void *p) noexcept
+    {
+        auto block_it = fallback_blocks_.find(p);
+        if (block_it == fallback_blocks_.end())
+            return false;
+
+        auto [bytes, alignment] = block_it->second;
+        options_.fallback->deallocate(p, bytes, alignment);
+        if constexpr (ENABLE_STATS)
+        {
+            stats_.fallback_bytes -= bytes;
+        }
+        fallback_blocks_.erase(block_it);
+        return true;
+    }
+
+    template <typename... Policies>
+    void BasicArenaMR<Policies...>::ReleaseFallbackBlocks() noexcept
+    {
+        for (auto const &[p, block] : fallback_blocks_)
+        {
+            options_.fallback->deallocate(p, block.bytes, block.alignment);
+        }
+        fallback_blocks_.clear();
+        if constexpr (ENABLE_STATS)
+        {
+            stats_.fallback_bytes = 0;
+        }
+    }
+
+} // namespace arena_mr
+
+#endif // ARENA_LIMITS
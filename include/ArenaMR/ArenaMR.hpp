@@ -2,33 +2,230 @@
 #define ARENA_MR
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <memory_resource>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <numeric>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "ArenaMR/ArenaPolicies.hpp"
+
 namespace arena_mr
 {
     namespace detail
     {
-        void *Align(void const *ptr, size_t alignment) noexcept
+        constexpr uintptr_t AlignUp(uintptr_t num, size_t alignment) noexcept
+        {
+            return (num + alignment - 1) & ~(alignment - 1);
+        }
+
+        inline void *Align(void const *ptr, size_t alignment) noexcept
         {
-            uintptr_t uintptr = reinterpret_cast<uintptr_t>(ptr);
-            uintptr_t aligned = (uintptr + alignment - 1) & ~(alignment - 1);
-            return reinterpret_cast<void *>(aligned);
+            return reinterpret_cast<void *>(AlignUp(reinterpret_cast<uintptr_t>(ptr), alignment));
         }
 
-        bool IsPowerOf2(size_t num) noexcept
+        constexpr bool IsPowerOf2(size_t num) noexcept
         {
             // return std::popcount(num) == 1;
             return (num > 0) && ((num & (num - 1)) == 0);
         }
+
+        // Number of bits needed to represent `num`
+        constexpr std::size_t BitWidth(std::size_t num) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return num == 0 ? 0 : sizeof(unsigned long long) * 8 - __builtin_clzll(num);
+#else
+            std::size_t width = 0;
+            for (; num != 0; num >>= 1)
+            {
+                ++width;
+            }
+            return width;
+#endif
+        }
     }
 
+    // Snapshot of the statistics of an arena resource.
+    // Counters stay zero unless statistics are enabled, see `ARENA_MR_ENABLE_STATS` and `WithStats`.
+    // Only `num_of_arenas` and `upstream_bytes` are always kept, the resource needs them anyway.
+    struct ArenaStats
+    {
+        std::size_t live_bytes = 0;        // Bytes requested by live allocations
+        std::size_t peak_live_bytes = 0;
+        std::size_t alignment_padding = 0; // Bytes skipped for alignment in arenas which are not free
+        std::size_t tail_waste = 0;        // Unused bytes at the end of full arenas
+
+        std::size_t num_of_arenas = 0;
+        std::size_t upstream_bytes = 0; // Bytes currently held from upstream, arenas and large objects. Always kept.
+        std::size_t peak_upstream_bytes = 0;
+        std::size_t upstream_allocations = 0;
+        std::size_t upstream_deallocations = 0;
+
+        std::size_t large_objects = 0; // Live large objects
+        std::size_t large_object_allocations = 0;
+
+        std::size_t remote_frees = 0; // Frees queued by other threads and drained by the owner
+
+        std::size_t tail_allocations = 0; // Requests served from the tail of a full arena
+
+        std::size_t soft_limit_events = 0;    // Times `upstream_bytes` went above `ArenaOptions::soft_limit`
+        std::size_t fallback_allocations = 0; // Requests served by `ArenaOptions::fallback`
+        std::size_t fallback_bytes = 0;       // Bytes currently held from `ArenaOptions::fallback`
+
+        std::size_t allocations = 0;
+        std::size_t deallocations = 0;
+
+        // Bucket i counts the requests of (2^(i-1), 2^i] bytes
+        std::array<std::size_t, sizeof(std::size_t) * 8 + 1> size_histogram{};
+    };
+
+    enum class ArenaState
+    {
+        Active,     // Serves the allocations
+        Full,       // Retired, waits until its allocations are freed
+        Free,       // In the free list
+        Decommitted // In the free list, its pages are given back to the OS
+    };
+
+    // Occupancy of one arena, see `Snapshot`.
+    struct ArenaSnapshot
+    {
+        void const *address = nullptr;
+        ArenaState state = ArenaState::Free;
+        std::size_t capacity = 0;
+        std::size_t num_of_allocation = 0; // Live allocations
+        std::size_t bytes_left = 0;
+        std::size_t alignment_padding = 0; // Only counted if statistics are enabled
+        std::size_t live_bytes = 0;        // Only counted if statistics are enabled
+    };
+
+    // Where the memory held from upstream goes, see `Fragmentation`.
+    struct FragmentationReport
+    {
+        std::size_t num_of_arenas = 0;
+        std::size_t active_arenas = 0;
+        std::size_t full_arenas = 0;
+        std::size_t free_arenas = 0;
+        std::size_t decommitted_arenas = 0;
+
+        std::size_t capacity = 0;   // Usable bytes of all arenas
+        std::size_t used_bytes = 0; // Bytes handed out from the arenas which are not free, freed ones included
+        std::size_t free_bytes = 0; // Capacity of the free arenas
+
+        std::size_t tail_waste = 0;        // Unused bytes at the end of full arenas
+        std::size_t alignment_padding = 0; // Only counted if statistics are enabled
+
+        // Full arenas which are kept only by a few survivors
+        std::size_t pinned_arenas = 0;
+        std::size_t pinned_bytes = 0;       // Capacity of the pinned arenas
+        std::size_t pinned_allocations = 0; // Survivors in the pinned arenas
+
+        std::size_t large_objects = 0; // Only counted if statistics are enabled
+        std::size_t large_object_bytes = 0;
+        std::size_t cached_large_object_bytes = 0;
+    };
+
+    enum class Prefault
+    {
+        None,
+        Sync,      // Pages of the initial arenas are touched in the constructor
+        Background // Pages of the initial arenas are populated by a background thread, requires `ArenaOptions::populate`
+    };
+
+    struct ArenaOptions
+    {
+        // Every arena is aligned to its own size so the arena of a pointer is found by masking the pointer.
+        // Deallocation does not search the arena map and adding an arena does not keep the map sorted.
+        // `size_per_arena` must be a power of 2.
+        bool aligned_arenas = false;
+
+        // High-water mark of the free arena list. An arena which becomes free while the list is already
+        // that long is given back to upstream. By default free arenas are kept until `Trim` or destruction.
+        std::size_t max_free_arenas = SIZE_MAX;
+
+        // Number of freed large objects kept for reuse instead of given back to upstream.
+        std::size_t large_object_cache = 0;
+
+        // Gives the physical pages of a free arena back to the OS while the arena itself is kept.
+        // e.g. `MmapMemoryResource::Decommit`. Called with the usable part of the arena, never with its header.
+        void (*decommit)(void *p, std::size_t bytes) noexcept = nullptr;
+
+        // Number of free arenas which stay committed when `decommit` is set. Arenas which become free beyond
+        // that are decommitted and reused only after the committed ones.
+        std::size_t committed_free_arenas = 0;
+
+        // Adaptive sizing. Every arena allocated because the pool is exhausted is `growth_factor` times bigger
+        // than the previous one, up to `max_size_per_arena` bytes. 1 keeps every arena at `size_per_arena`.
+        // Requests which do not fit into `size_per_arena` are still served as large objects.
+        // Not supported with `aligned_arenas`.
+        double growth_factor = 1;
+        std::size_t max_size_per_arena = SIZE_MAX;
+
+        // Number of full arenas whose unused tails serve the requests which do not fit into the active arena.
+        // Best fit by the space left. Not used while marks are outstanding.
+        std::size_t tail_reuse = 0;
+
+        // The initial arenas are carved out of a single upstream allocation and set up on first use.
+        // They are given back to upstream only on destruction, `Trim` and `max_free_arenas` skip them.
+        bool lazy_arenas = false;
+
+        // Touches the pages of the initial arenas up front so first requests do not page fault.
+        Prefault prefault = Prefault::None;
+
+        // Faults pages in without changing the memory, e.g. `MmapMemoryResource::Populate`. Returns false if the
+        // system does not support it. `Prefault::Background` falls back to `Prefault::Sync` without it.
+        bool (*populate)(void *p, std::size_t bytes) noexcept = nullptr;
+
+        // Number of lifetime classes. Every class has its own active arena, so objects which are freed soon do not
+        // share arenas with objects which stay, see `AllocateFor` and `LifetimeResource`. Class 0 is the default.
+        std::size_t lifetime_classes = 1;
+
+        // Memory budget on the bytes held from upstream, arenas and large objects. Only checked when the resource grows.
+        // `soft_limit_callback` is called each time the budget goes above `soft_limit`, e.g. to shed load. It is called
+        // while the resource is locked and must not use the resource.
+        std::size_t soft_limit = SIZE_MAX;
+        void (*soft_limit_callback)(void *context, std::size_t upstream_bytes) = nullptr;
+        void *soft_limit_context = nullptr;
+
+        // Growth beyond `hard_limit` throws `std::bad_alloc`, or the request is served by `fallback` if it is set.
+        // Fallback blocks are freed one by one, by `Reset` or on destruction, marks do not rewind them.
+        std::size_t hard_limit = SIZE_MAX;
+        std::pmr::memory_resource *fallback = nullptr;
+
+        // Holds the arena map and the other lists of the resource, nullptr means upstream. Set it if upstream does
+        // not reuse freed memory, e.g. a `SharedSegment`, where every growth of the lists would be lost.
+        std::pmr::memory_resource *bookkeeping = nullptr;
+
+        // Requests aligned to more than `std::max_align_t`, up to this alignment, get an active arena per alignment, e.g.
+        // 4096 for page aligned I/O buffers. Their sizes are rounded up to the alignment, so only the first request
+        // of an arena pads and they do not share cache lines or pages with other objects. Marks, `TryExtend` and tail
+        // reuse do not cover them. 0 disables it.
+        std::size_t dedicated_alignment = 0;
+
+        // Rounds every request up to whole cache lines of this size and aligns it to them, so objects which are handed
+        // to different threads do not share a cache line. 0 disables it.
+        std::size_t cache_line_padding = 0;
+
+        // Size of new arenas is also chosen from tiers of `size_per_arena * 2^k` so that an arena fits many of the
+        // requests which recently did not fit into the active arena. Keeps tail waste low for big requests.
+        // Requests up to the largest tier, at most `max_size_per_arena` and 128 times `size_per_arena`, are served
+        // from arenas instead of as large objects.
+        bool size_tiers = false;
+    };
+
+    // Lives in-band at the beginning of the memory of its arena.
     struct ArenaInfo
     {
         ArenaInfo() = default;
@@ -44,17 +241,31 @@ namespace arena_mr
         std::size_t num_of_allocation = 0;
         std::size_t bytes_left = 0;
         std::byte *cursor = nullptr;
+        std::size_t alignment_padding = 0; // Only counted if statistics are enabled
+        std::size_t live_bytes = 0;        // Only counted if statistics are enabled
 
         std::size_t Capacity() const noexcept
         {
             return capacity_;
         }
 
-        void Reduce(std::size_t bytes) noexcept
+        // First usable byte of the arena
+        std::byte *Begin() noexcept;
+
+        void Reduce(std::size_t bytes, std::size_t count = 1) noexcept
         {
             bytes_left -= bytes;
             cursor += bytes;
-            num_of_allocation += 1;
+            num_of_allocation += count;
+        }
+
+        void Reset() noexcept
+        {
+            num_of_allocation = 0;
+            bytes_left = capacity_;
+            cursor = Begin();
+            alignment_padding = 0;
+            live_bytes = 0;
         }
 
         void *AlignedCursor(std::size_t alignment) noexcept
@@ -66,239 +277,1932 @@ namespace arena_mr
         std::size_t capacity_ = 0;
     };
 
+    // Lifetime classes for `ArenaOptions::lifetime_classes = 2`. Any class below `lifetime_classes` can be used.
+    static constexpr std::size_t SHORT_LIVED = 0;
+    static constexpr std::size_t LONG_LIVED = 1;
+
+    // Size of the in-band header. Keeps the first usable byte of an arena aligned to `std::max_align_t`.
+    static constexpr std::size_t ARENA_HEADER_SIZE = (sizeof(ArenaInfo) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    inline std::byte *ArenaInfo::Begin() noexcept
+    {
+        return reinterpret_cast<std::byte *>(this) + ARENA_HEADER_SIZE;
+    }
+
+    // Lives in-band just before the memory of a large object.
+    // Requests which do not fit into an arena are served directly from upstream and never touch the arenas.
+    struct LargeObjectInfo
+    {
+        LargeObjectInfo *prev = nullptr;
+        LargeObjectInfo *next = nullptr;
+        std::byte *block = nullptr; // Memory allocated from upstream
+        std::size_t block_size = 0;
+        std::size_t block_alignment = 0;
+        std::size_t bytes = 0;    // Requested by the user
+        std::size_t sequence = 0; // Allocation order, decides whether a rewind frees the object
+    };
+
+    static constexpr std::size_t LARGE_OBJECT_HEADER_SIZE = (sizeof(LargeObjectInfo) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+    // Lives in-band in the memory freed by a thread which does not own the resource, until the owner drains it.
+    struct RemoteFreeInfo
+    {
+        RemoteFreeInfo *next = nullptr;
+        std::size_t bytes = 0;
+        std::size_t alignment = 0;
+    };
+
+    // Position returned by `Mark`. Everything allocated after it is freed by `RewindTo`.
+    struct ArenaMark
+    {
+        std::size_t depth = 0;        // Number of outstanding marks including this one
+        std::size_t log_position = 0; // First arena activated after the mark in the activation log
+        std::size_t large_object_sequence = 0;
+    };
+
+    // See ArenaDetach.hpp
+    class ArenaHandle;
+
+    // See ArenaClasses.hpp
+    template <typename ArenaResource>
+    class LifetimeResource;
+
     /*
-        A non-thread-safe memory resource that manages pools of memory.
+        A memory resource that manages pools of memory.
 
-        * Do not access to moved `UnsynchronizedArenaMR` object.
+        Policies can be given in any order, e.g. `BasicArenaMR<FixedArenaSize<4096>, AlignedLayout>`.
+        Features which are not selected cost nothing.
+
+        * Arena size: `RuntimeArenaSize`, `FixedArenaSize<N>`
+        * Locking: `NoLock`, `MutexLock`
+        * Statistics: `DefaultStats` (depends on `ARENA_MR_ENABLE_STATS`), `NoStats`, `WithStats`
+        * Large objects: `TrackedLargeObjects`, `ForwardedLargeObjects`
+        * Metadata layout: `RuntimeLayout`, `SortedLayout`, `AlignedLayout`
+        * Cross-thread deallocation: `NoRemoteFree`, `RemoteFreeQueue`
+        * Features: `CoreFeatures`, `ExtendedFeatures` for padding, alignment and lifetime classes, tail reuse and
+          fallback
+        * Movable. Containers keep a pointer to the resource, so move it before it is used by containers.
+        * `final`, so calls through the concrete type are not virtual. See `ArenaAllocator`.
+        * Do not access to moved `BasicArenaMR` object.
     */
-    class UnsynchronizedArenaMR : public std::pmr::memory_resource
+    template <typename... Policies>
+    class BasicArenaMR final : public std::pmr::memory_resource
     {
+        using ArenaSizePolicy = detail::SelectPolicyT<ArenaSizePolicyTag, RuntimeArenaSize, Policies...>;
+        using LockPolicy = detail::SelectPolicyT<LockPolicyTag, NoLock, Policies...>;
+        using StatsPolicy = detail::SelectPolicyT<StatsPolicyTag, DefaultStats, Policies...>;
+        using LargeObjectPolicy = detail::SelectPolicyT<LargeObjectPolicyTag, TrackedLargeObjects, Policies...>;
+        using LayoutPolicy = detail::SelectPolicyT<LayoutPolicyTag, RuntimeLayout, Policies...>;
+        using RemoteFreePolicy = detail::SelectPolicyT<RemoteFreePolicyTag, NoRemoteFree, Policies...>;
+        using FeaturePolicy = detail::SelectPolicyT<FeaturePolicyTag, CoreFeatures, Policies...>;
+
     public:
-        explicit UnsynchronizedArenaMR(std::size_t num_of_arenas, std::size_t size_per_arena, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+        explicit BasicArenaMR(std::size_t num_of_arenas, std::size_t size_per_arena, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+            : BasicArenaMR(num_of_arenas, size_per_arena, ArenaOptions{}, upstream)
+        {
+        }
+
+        BasicArenaMR(std::size_t num_of_arenas, std::size_t size_per_arena, ArenaOptions const &options, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
             : num_of_arenas_(num_of_arenas),
               size_per_arena_(size_per_arena),
+              options_(WithFeatures(WithLayout(options))),
               upstream_{upstream},
-              arena_info_map_(upstream_),
-              free_arena_list_(upstream_)
+              arena_info_map_(BookkeepingResource()),
+              free_arena_list_(BookkeepingResource()),
+              large_object_cache_(BookkeepingResource()),
+              lifetime_arenas_(BookkeepingResource()),
+              fallback_blocks_(BookkeepingResource()),
+              tail_arenas_(BookkeepingResource()),
+              activation_log_(BookkeepingResource())
         {
             assert(num_of_arenas > 0);
+            assert(ArenaSizePolicy::VALUE == 0 || size_per_arena == ArenaSizePolicy::VALUE);
             assert(size_per_arena % alignof(std::max_align_t) == 0);
+            assert(LayoutPolicy::RUNTIME || LayoutPolicy::ALIGNED || !options.aligned_arenas);
+            assert(!IsAligned() || (detail::IsPowerOf2(size_per_arena) && size_per_arena >= 2 * ARENA_HEADER_SIZE));
+            assert(options.growth_factor >= 1 && options.max_size_per_arena >= size_per_arena);
+            assert(!IsAligned() || (options.growth_factor == 1 && !options.size_tiers));
+            assert(LargeObjectPolicy::TRACKED || options.large_object_cache == 0);
+            assert(options.lifetime_classes > 0);
+            assert(options.dedicated_alignment == 0 || detail::IsPowerOf2(options.dedicated_alignment));
+            assert(options.cache_line_padding == 0 || detail::IsPowerOf2(options.cache_line_padding));
+            assert(FeaturePolicy::EXTENDED || (options.cache_line_padding == 0 && options.dedicated_alignment == 0 &&
+                                               options.lifetime_classes == 1 && options.tail_reuse == 0 && options.fallback == nullptr));
+            next_arena_capacity_ = ArenaCapacity();
+            max_tier_capacity_ = MaxTierCapacity();
+            large_object_cache_.reserve(options.large_object_cache);
+            tail_arenas_.reserve(options_.tail_reuse);
             InitializeArenas();
         }
 
-        UnsynchronizedArenaMR(UnsynchronizedArenaMR const &) = delete;
-        UnsynchronizedArenaMR &operator=(UnsynchronizedArenaMR const &) = delete;
-        virtual ~UnsynchronizedArenaMR() {}
-
-        // TODO Write another function to get current number of arenas.
-
-        // Initial value for number of arenas
-        std::size_t NumOfArenas() const noexcept
+        // Only with `FixedArenaSize`
+        explicit BasicArenaMR(std::size_t num_of_arenas, ArenaOptions const &options = {}, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+            : BasicArenaMR(num_of_arenas, ArenaSizePolicy::VALUE, options, upstream)
         {
-            return num_of_arenas_;
+            static_assert(ArenaSizePolicy::VALUE != 0, "Size per arena is not known at compile time");
         }
 
-        // Initial value for size per arena
-        std::size_t SizePerArena() const noexcept
-        {
-            return size_per_arena_;
-        }
+        BasicArenaMR(BasicArenaMR const &) = delete;
+        BasicArenaMR &operator=(BasicArenaMR const &) = delete;
 
-        // Test Function
-        // Number of free arenas
-        std::size_t FreeArenaSize() const noexcept
+        // Same as `allocate` without the virtual call, so the bump of the cursor can be inlined into the caller.
+        void *Allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
         {
-            return free_arena_list_.size();
-        }
+            assert(!arena_info_map_.empty()); // Access to moved object
 
-        // Test Function
-        // Memory used by the user.
-        // Can be greater than user allocated space because of the alignment.
-        std::size_t UsedMemory() const noexcept
-        {
-            std::size_t total_allocated_bytes = 0;
-            for (auto const &[_, info] : arena_info_map_)
+            if (bytes == 0)
+                return nullptr;
+
+            std::lock_guard lock(mutex_);
+
+            auto dedicated = PadRequest(bytes, alignment);
+
+            if constexpr (RemoteFreePolicy::ENABLED)
             {
-                total_allocated_bytes += info->Capacity() - info->bytes_left;
+                AdjustRequest(bytes, alignment);
+
+                if (remote_free_list_.load(std::memory_order_relaxed) != nullptr)
+                {
+                    CollectRemoteFrees();
+                }
             }
-            return total_allocated_bytes;
-        }
 
-        // Test Function
-        // Return the memory that is end of the arena but the arena itself is not active
-        // The end of the arena cannot be used until it is free again. Thus it is wasted space.
-        std::size_t WastedMemory() const noexcept
-        {
-            std::size_t wasted_bytes = 0;
-            for (auto const &[_, info] : arena_info_map_)
+            CountRequests(bytes, 1);
+
+            if (IsOversized(bytes, alignment))
+                return AllocateLargeObject(bytes, alignment);
+
+            if constexpr (FeaturePolicy::EXTENDED)
             {
-                auto is_arena_free = std::find(free_arena_list_.begin(), free_arena_list_.end(), info.get()) != free_arena_list_.end();
-                if (!is_arena_free && (info.get() != active_arena_info_))
+                if (dedicated)
                 {
-                    wasted_bytes += info->bytes_left;
+                    ActiveClass active_class(*this, AlignmentClass(alignment));
+                    return DoAllocateDetails(bytes, alignment);
                 }
             }
-            return wasted_bytes;
+
+            return DoAllocateDetails(bytes, alignment);
         }
 
-    private:
-        void AllocateArena(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+        // Same as `count` calls of `Allocate(bytes, alignment)`, the blocks are written to `ptrs`. Every run of blocks
+        // which fits into the active arena is taken at once. If it throws, nothing stays allocated.
+        void AllocateBatch(std::size_t count, std::size_t bytes, std::size_t alignment, void **ptrs)
         {
-            auto *arena = (std::byte *)upstream_->allocate(bytes, alignment);
-            auto arena_info = std::make_unique<ArenaInfo>(0, bytes, arena);
-            free_arena_list_.push_back(arena_info.get());
+            assert(!arena_info_map_.empty()); // Access to moved object
+
+            if (bytes == 0)
+            {
+                std::fill_n(ptrs, count, nullptr);
+                return;
+            }
 
-            // Insert to already sorted array and keep it sorted
+            std::lock_guard lock(mutex_);
 
-            auto insert_it = std::upper_bound(arena_info_map_.begin(), arena_info_map_.end(), (void *)arena,
-                                              [](void *ptr, auto const &arena_pair)
-                                              { return ptr < arena_pair.first; });
+            auto dedicated = PadRequest(bytes, alignment);
 
-            arena_info_map_.insert(insert_it, std::make_pair(arena, std::move(arena_info)));
+            if constexpr (RemoteFreePolicy::ENABLED)
+            {
+                AdjustRequest(bytes, alignment);
 
-            assert(true == std::is_sorted(arena_info_map_.begin(), arena_info_map_.end(),
-                                          [](auto const &arena_pair1, auto const &arena_pair2)
-                                          { return arena_pair1.first < arena_pair2.first; }));
-        }
+                if (remote_free_list_.load(std::memory_order_relaxed) != nullptr)
+                {
+                    CollectRemoteFrees();
+                }
+            }
 
-        void InitializeArenas()
-        {
-            arena_info_map_.push_back(std::make_pair(MIN_POINTER, std::make_unique<ArenaInfo>())); // Limit to the bottom of the map
+            ActiveClass active_class(*this, dedicated ? AlignmentClass(alignment) : 0);
 
-            // TODO: We just need to sort once.
+            std::size_t num_of_done = 0;
+            try
+            {
+                while (num_of_done < count)
+                {
+                    auto num_of_blocks = IsOversized(bytes, alignment) ? 0 : BumpBatch(count - num_of_done, bytes, alignment, ptrs + num_of_done);
 
-            for (size_t i = 0; i < NumOfArenas(); i++)
+                    if (num_of_blocks == 0)
+                    {
+                        // One by one through the slow path, which makes room in the active arena
+                        ptrs[num_of_done] = IsOversized(bytes, alignment) ? AllocateLargeObject(bytes, alignment) : AllocateFromNextArena(bytes, alignment);
+                        num_of_blocks = 1;
+                    }
+
+                    CountRequests(bytes, num_of_blocks);
+                    num_of_done += num_of_blocks;
+                }
+            }
+            catch (...)
             {
-                AllocateArena(SizePerArena());
+                for (auto i = num_of_done; i-- > 0;)
+                {
+                    DoDeallocateDetails(ptrs[i], bytes, alignment);
+                }
+                throw;
             }
-
-            // get the first active arena
-            active_arena_info_ = free_arena_list_.back();
-            free_arena_list_.pop_back();
         }
 
-        void *DoAllocateDetails(std::size_t bytes, std::size_t alignment)
+        // Same as `Deallocate` for every pointer of `ptrs` from the last one to the first one. Pointers in a row
+        // which belong to the same arena update it once. Zero-byte batches hold null pointers only, like `AllocateBatch`
+        // returns them, and are ignored. Otherwise pointers must not be null.
+        void DeallocateBatch(std::size_t count, std::size_t bytes, std::size_t alignment, void *const *ptrs) noexcept
         {
-            assert(detail::IsPowerOf2(alignment));
+            if (bytes == 0)
+                return;
 
-            auto aligned_cursor = active_arena_info_->AlignedCursor(alignment);
-            auto bytes_needed = ((std::byte *)aligned_cursor - active_arena_info_->cursor) + bytes;
+            PadRequest(bytes, alignment);
 
-            if (bytes_needed > active_arena_info_->bytes_left)
+            if constexpr (RemoteFreePolicy::ENABLED)
             {
-                if (bytes > SizePerArena())
+                AdjustRequest(bytes, alignment);
+
+                if (std::this_thread::get_id() != owner_)
                 {
-                    // Needed bytes is greater than size per arena.
-                    // Always cause new allocation.
-                    AllocateArena(bytes); // We can return the inserted so that we will not need to search for the iterator.
-
-                    // We do not want this to change active arena because this arena will be consumed immidiately.
-                    auto *cur_big_arena = free_arena_list_.back();
-                    free_arena_list_.pop_back();
-
-                    // Don't need to do these calculations. Bytes needed is equal to capacity.
-                    aligned_cursor = cur_big_arena->AlignedCursor(alignment);
-                    bytes_needed = ((std::byte *)aligned_cursor - cur_big_arena->cursor) + bytes;
-                    cur_big_arena->Reduce(bytes_needed);
-                    return aligned_cursor;
+                    for (std::size_t i = count; i-- > 0;)
+                    {
+                        PushRemoteFree(ptrs[i], bytes, alignment);
+                    }
+                    return;
                 }
-                else if (free_arena_list_.empty())
+            }
+
+            assert(!arena_info_map_.empty()); // Access to moved object
+
+            std::lock_guard lock(mutex_);
+
+            if (IsOversized(bytes, alignment) || HasFallbackBlocks())
+            {
+                // Not in arenas, at least not all of them
+                for (std::size_t i = count; i-- > 0;)
                 {
-                    AllocateArena(SizePerArena());
+                    DoDeallocateDetails(ptrs[i], bytes, alignment);
                 }
+                return;
+            }
 
-                // If the assertion below happens we will loose the arena pointed by current `active_arena_info_`.
-                // However this case should not happen because we of the check `bytes > SizePerArena()`.
-                assert(active_arena_info_->num_of_allocation != 0);
-
-                active_arena_info_ = free_arena_list_.back();
-                free_arena_list_.pop_back();
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.deallocations += count;
+                stats_.live_bytes -= count * bytes;
+            }
 
-                // We know that there is enough space in the current arena.
-                // Recalculate `aligned_cursor` and `bytes_needed`
+            auto i = count;
+            while (i > 0)
+            {
+                auto *arena = FindArena(ptrs[i - 1]);
+                auto *arena_begin = arena->Begin();
+                auto *arena_end = arena_begin + arena->Capacity();
+                auto is_active = IsActive(arena);
 
-                aligned_cursor = active_arena_info_->AlignedCursor(alignment);
-                bytes_needed = ((std::byte *)aligned_cursor - active_arena_info_->cursor) + bytes;
+                std::size_t num_of_frees = 0;
+                for (; i > 0 && static_cast<std::byte *>(ptrs[i - 1]) >= arena_begin && static_cast<std::byte *>(ptrs[i - 1]) < arena_end; --i)
+                {
+                    auto *p = static_cast<std::byte *>(ptrs[i - 1]);
+                    if (p + bytes == arena->cursor && is_active)
+                    {
+                        arena->bytes_left += bytes;
+                        arena->cursor = p;
+                    }
+                    num_of_frees += 1;
+                }
 
-                // active_arena_info_->Reduce(bytes_needed);
-                // return aligned_cursor;
-            }
+                assert(arena->num_of_allocation >= num_of_frees); // Else double free or memory corruption
+                arena->num_of_allocation -= num_of_frees;
 
-            // Enough space in current arena.
+                if constexpr (ENABLE_STATS)
+                {
+                    arena->live_bytes -= num_of_frees * bytes;
+                }
 
-            active_arena_info_->Reduce(bytes_needed);
-            return aligned_cursor;
+                if (arena->num_of_allocation == 0)
+                {
+                    ResetArena(arena);
+                }
+            }
         }
 
-    protected:
-        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        // Allocates from the active arena of the lifetime class. Deallocate as usual.
+        // Marks, `TryExtend` and tail reuse only cover class 0, allocations of other classes are not rewound.
+        void *AllocateFor(std::size_t lifetime, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+        // Same as `deallocate` without the virtual call.
+        // `bytes` and `alignment` must be the same as the allocation, they decide whether `p` is a large object.
+        void Deallocate(void *p, std::size_t bytes = 0, std::size_t alignment = alignof(std::max_align_t)) noexcept
         {
+            if (p == nullptr)
+                return;
+
+            PadRequest(bytes, alignment);
+
+            if constexpr (RemoteFreePolicy::ENABLED)
+            {
+                AdjustRequest(bytes, alignment);
+
+                if (std::this_thread::get_id() != owner_)
+                {
+                    PushRemoteFree(p, bytes, alignment);
+                    return;
+                }
+            }
+
             assert(!arena_info_map_.empty()); // Access to moved object
 
-            if (bytes == 0)
-                return nullptr;
+            std::lock_guard lock(mutex_);
+            DoDeallocateDetails(p, bytes, alignment);
+        }
 
-            return DoAllocateDetails(bytes, alignment);
+        // Takes over every arena, large object and counter. Not thread-safe, `other` must not be in use.
+        BasicArenaMR(BasicArenaMR &&other) noexcept
+            : num_of_arenas_(other.num_of_arenas_),
+              size_per_arena_(other.size_per_arena_),
+              options_(other.options_),
+              upstream_{other.upstream_},
+              arena_info_map_(std::move(other.arena_info_map_)),
+              free_arena_list_(std::move(other.free_arena_list_)),
+              num_of_decommitted_arenas_(std::exchange(other.num_of_decommitted_arenas_, 0)),
+              large_object_list_(std::exchange(other.large_object_list_, nullptr)),
+              large_object_bytes_(std::exchange(other.large_object_bytes_, 0)),
+              large_object_cache_(std::move(other.large_object_cache_)),
+              stats_(std::exchange(other.stats_, {})),
+              upstream_bytes_(std::exchange(other.upstream_bytes_, 0)),
+              next_arena_capacity_(other.next_arena_capacity_),
+              miss_histogram_(other.miss_histogram_),
+              num_of_misses_(other.num_of_misses_),
+              largest_miss_(other.largest_miss_),
+              max_tier_capacity_(other.max_tier_capacity_),
+              active_arena_info_(std::exchange(other.active_arena_info_, nullptr)),
+              reservation_(std::exchange(other.reservation_, nullptr)),
+              reservation_size_(std::exchange(other.reservation_size_, 0)),
+              num_of_materialized_arenas_(std::exchange(other.num_of_materialized_arenas_, 0)),
+              prefault_thread_(std::move(other.prefault_thread_)),
+              lifetime_arenas_(std::move(other.lifetime_arenas_)),
+              above_soft_limit_(std::exchange(other.above_soft_limit_, false)),
+              fallback_blocks_(std::move(other.fallback_blocks_)),
+              tail_arenas_(std::move(other.tail_arenas_)),
+              activation_log_(std::move(other.activation_log_)),
+              num_of_marks_(std::exchange(other.num_of_marks_, 0)),
+              large_object_sequence_(other.large_object_sequence_),
+              owner_(other.owner_),
+              remote_free_list_(other.remote_free_list_.exchange(nullptr))
+        {
         }
 
-        void do_deallocate(void *p, [[maybe_unused]] std::size_t bytes = 0, [[maybe_unused]] std::size_t alignment = alignof(std::max_align_t)) noexcept override
+        // Gives the arenas of this resource back to upstream, then takes over the ones of `other`.
+        // The bookkeeping keeps the resource given on construction, containers of a resource never change theirs.
+        BasicArenaMR &operator=(BasicArenaMR &&other)
         {
-            assert(!arena_info_map_.empty()); // Access to moved object
+            if (this == &other)
+                return *this;
 
-            if (p == nullptr)
-                return;
+            // Only allocates if the bookkeeping resources are not equal. Nothing is changed until here.
+            arena_info_map_.reserve(other.arena_info_map_.size());
+            free_arena_list_.reserve(other.arena_info_map_.size());
+            large_object_cache_.reserve(other.options_.large_object_cache);
+            lifetime_arenas_.reserve(other.lifetime_arenas_.size());
+            tail_arenas_.reserve(other.options_.tail_reuse);
+            activation_log_.reserve(other.activation_log_.size());
 
-            auto arena_it = std::prev(std::upper_bound(arena_info_map_.begin(), arena_info_map_.end(), p,
-                                                       [](void *ptr, auto const &arena_pair)
-                                                       { return ptr < arena_pair.first; }));
+            ReleaseAll();
 
-            // If pointer is allocated from this allocator it should be found in the `arena_info_map_`.
-            assert(arena_it->first != MIN_POINTER);
+            num_of_arenas_ = other.num_of_arenas_;
+            size_per_arena_ = other.size_per_arena_;
+            options_ = other.options_;
+            upstream_ = other.upstream_;
+            arena_info_map_ = std::move(other.arena_info_map_);
+            free_arena_list_ = std::move(other.free_arena_list_);
+            num_of_decommitted_arenas_ = std::exchange(other.num_of_decommitted_arenas_, 0);
+            large_object_list_ = std::exchange(other.large_object_list_, nullptr);
+            large_object_bytes_ = std::exchange(other.large_object_bytes_, 0);
+            large_object_cache_ = std::move(other.large_object_cache_);
+            stats_ = std::exchange(other.stats_, {});
+            upstream_bytes_ = std::exchange(other.upstream_bytes_, 0);
+            next_arena_capacity_ = other.next_arena_capacity_;
+            miss_histogram_ = other.miss_histogram_;
+            num_of_misses_ = other.num_of_misses_;
+            largest_miss_ = other.largest_miss_;
+            max_tier_capacity_ = other.max_tier_capacity_;
+            active_arena_info_ = std::exchange(other.active_arena_info_, nullptr);
+            reservation_ = std::exchange(other.reservation_, nullptr);
+            reservation_size_ = std::exchange(other.reservation_size_, 0);
+            num_of_materialized_arenas_ = std::exchange(other.num_of_materialized_arenas_, 0);
+            prefault_thread_ = std::move(other.prefault_thread_);
+            lifetime_arenas_ = std::move(other.lifetime_arenas_);
+            above_soft_limit_ = std::exchange(other.above_soft_limit_, false);
+            fallback_blocks_ = std::move(other.fallback_blocks_);
+            tail_arenas_ = std::move(other.tail_arenas_);
+            activation_log_ = std::move(other.activation_log_);
+            num_of_marks_ = std::exchange(other.num_of_marks_, 0);
+            large_object_sequence_ = other.large_object_sequence_;
+            owner_ = other.owner_;
+            remote_free_list_.store(other.remote_free_list_.exchange(nullptr));
 
-            auto &arena = arena_it->second;
+            // Moved element by element if the bookkeeping resources are not equal
+            other.arena_info_map_.clear();
+            other.free_arena_list_.clear();
+            other.large_object_cache_.clear();
+            other.lifetime_arenas_.clear();
+            other.fallback_blocks_.clear();
+            other.tail_arenas_.clear();
+            other.activation_log_.clear();
 
-            assert(arena->num_of_allocation > 0); // Else double free or memory corruption
-            arena->num_of_allocation -= 1;
+            return *this;
+        }
 
-            // Does not free the allocated arena until num_of_allocation is 0.
+        // Gives every arena back to upstream. Memory allocated from the resource must not be used afterwards.
+        virtual ~BasicArenaMR()
+        {
+            ReleaseAll();
+        }
 
-            if (arena->num_of_allocation == 0)
+        // Gives free arenas back to upstream until at most `keep_free` of them are left.
+        // Cached large objects are always released, then the least recently freed arenas.
+        // Returns the number of bytes given back to upstream.
+        std::size_t Trim(std::size_t keep_free = 0) noexcept
+        {
+            std::lock_guard lock(mutex_);
+
+            std::size_t released_bytes = TrimLargeObjectCache();
+
+            if (free_arena_list_.size() <= keep_free)
+                return released_bytes;
+
+            auto num_to_release = free_arena_list_.size() - keep_free;
+            std::size_t num_of_kept = 0;
+            std::size_t num_of_kept_decommitted = 0;
+
+            // Free arenas are taken from the back of the list. The front holds the least recently used ones.
+            for (std::size_t i = 0; i < num_to_release; ++i)
             {
-                arena->num_of_allocation = 0;
-                arena->bytes_left = arena->Capacity();
-                arena->cursor = (std::byte *)arena_it->first;
+                auto *arena = free_arena_list_[i];
 
-                if (arena.get() != active_arena_info_)
+                if (IsReserved(arena))
                 {
-                    // This cannot cause allocation because we are just returning the arena back to `free_arena_list`.
-                    free_arena_list_.push_back(arena.get());
+                    // Part of the reservation. Stays in the list in the same order.
+                    num_of_kept_decommitted += i < num_of_decommitted_arenas_ ? 1 : 0;
+                    free_arena_list_[num_of_kept++] = arena;
+                    continue;
                 }
+
+                released_bytes += ARENA_HEADER_SIZE + arena->Capacity();
+                ReleaseArena(arena);
             }
+
+            free_arena_list_.erase(free_arena_list_.begin() + num_of_kept, free_arena_list_.begin() + num_to_release);
+            num_of_decommitted_arenas_ = num_of_kept_decommitted + (num_of_decommitted_arenas_ - std::min(num_of_decommitted_arenas_, num_to_release));
+            return released_bytes;
         }
 
-        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+        // Decommits the least recently freed arenas until at most `keep_committed` free arenas are committed.
+        // Requires `ArenaOptions::decommit`. Returns the number of bytes decommitted.
+        std::size_t Decommit(std::size_t keep_committed = 0) noexcept
         {
-            assert(!arena_info_map_.empty()); // Access to moved object
+            assert(options_.decommit != nullptr);
 
-            return (this == &other);
+            std::lock_guard lock(mutex_);
+
+            std::size_t decommitted_bytes = 0;
+            while (free_arena_list_.size() - num_of_decommitted_arenas_ > keep_committed)
+            {
+                // Committed arenas start right after the decommitted ones.
+                auto *arena = free_arena_list_[num_of_decommitted_arenas_++];
+                options_.decommit(arena->Begin(), arena->Capacity());
+                decommitted_bytes += arena->Capacity();
+            }
+            return decommitted_bytes;
         }
 
-    private:
-        static constexpr void *MIN_POINTER = nullptr;
+        // Test Function
+        // Number of free arenas whose pages are given back to the OS
+        std::size_t DecommittedArenaSize() const noexcept
+        {
+            return num_of_decommitted_arenas_;
+        }
 
-        std::size_t num_of_arenas_;  // Number of arenas.
-        std::size_t size_per_arena_; // Size of each arena in bytes.
+        // Resizes the most recent allocation of the active arena in place.
+        // Returns false if `p` is not the most recent allocation or the active arena has not enough space left,
+        // then the caller has to allocate new memory and copy.
+        // `alignment` must be the same as the allocation. Deallocate with `new_bytes` after a successful call.
+        bool TryExtend(void *p, std::size_t old_bytes, std::size_t new_bytes, std::size_t alignment = alignof(std::max_align_t)) noexcept
+        {
+            auto old_alignment = alignment;
+            PadRequest(old_bytes, old_alignment);
+            PadRequest(new_bytes, alignment);
 
-        std::pmr::memory_resource *upstream_;
+            if constexpr (RemoteFreePolicy::ENABLED)
+            {
+                AdjustRequest(old_bytes, old_alignment);
+                AdjustRequest(new_bytes, alignment);
+            }
 
-        std::pmr::vector<std::pair<void *, std::unique_ptr<ArenaInfo>>> arena_info_map_;
+            std::lock_guard lock(mutex_);
 
-        std::pmr::vector<ArenaInfo *> free_arena_list_;
+            if (p == nullptr || IsOversized(old_bytes, alignment) || IsOversized(new_bytes, alignment))
+                return false;
 
-        ArenaInfo *active_arena_info_;
+            auto *arena = active_arena_info_;
+            auto *begin = (std::byte *)p;
 
-    }; // UnsynchronizedArenaMR
+            if (begin < arena->Begin() || begin + old_bytes != arena->cursor)
+                return false;
 
-} // namespace arena_mr
+            if (new_bytes > old_bytes && new_bytes - old_bytes > arena->bytes_left)
+                return false;
+
+            arena->bytes_left = arena->bytes_left + old_bytes - new_bytes;
+            arena->cursor = begin + new_bytes;
+
+            if constexpr (ENABLE_STATS)
+            {
+                arena->live_bytes = arena->live_bytes + new_bytes - old_bytes;
+                stats_.live_bytes = stats_.live_bytes + new_bytes - old_bytes;
+                stats_.peak_live_bytes = std::max(stats_.peak_live_bytes, stats_.live_bytes);
+            }
+            return true;
+        }
+
+        // Starts a new arena for the allocations after the mark unless the active arena is empty.
+        // The tail of the previous active arena is wasted until its allocations are freed.
+        ArenaMark Mark()
+        {
+            std::lock_guard lock(mutex_);
+
+            if (active_arena_info_->num_of_allocation != 0)
+            {
+                ActivateNextArena();
+            }
+
+            num_of_marks_ += 1;
+            ArenaMark mark{num_of_marks_, activation_log_.size(), large_object_sequence_};
+            activation_log_.push_back(active_arena_info_);
+            return mark;
+        }
+
+        // Frees every allocation made after `mark` without visiting them. Costs one cursor reset per arena used since
+        // the mark. Objects allocated after the mark must not be used or deallocated afterwards.
+        // `mark` and every later mark are invalid afterwards.
+        void RewindTo(ArenaMark const &mark) noexcept
+        {
+            static_assert(LargeObjectPolicy::TRACKED, "Forwarded large objects cannot be rewound");
+
+            std::lock_guard lock(mutex_);
+
+            // Queued frees may belong to rewound objects.
+            CollectRemoteFrees();
+
+            assert(mark.depth != 0 && mark.depth <= num_of_marks_); // Else the mark is already rewound
+            assert(mark.log_position <= activation_log_.size());
+
+            while (large_object_list_ != nullptr && large_object_list_->sequence >= mark.large_object_sequence)
+            {
+                auto *large_object = large_object_list_;
+                if constexpr (ENABLE_STATS)
+                {
+                    stats_.live_bytes -= large_object->bytes;
+                }
+                DeallocateLargeObject((std::byte *)large_object + LARGE_OBJECT_HEADER_SIZE, large_object->bytes, large_object->block_alignment);
+            }
+
+            // Every arena in the log was empty when it was activated, so it only holds allocations made after the mark.
+            for (auto it = activation_log_.begin() + mark.log_position; it != activation_log_.end(); ++it)
+            {
+                auto *arena = *it;
+
+                // Released, or already free because all of its allocations were freed
+                if (arena == nullptr || (!IsActive(arena) && arena->num_of_allocation == 0))
+                    continue;
+
+                ResetArena(arena);
+            }
+
+            num_of_marks_ = mark.depth - 1;
+            activation_log_.erase(activation_log_.begin() + mark.log_position, activation_log_.end());
+
+            // The active arena keeps serving the outer marks.
+            if (num_of_marks_ != 0)
+            {
+                // This cannot cause allocation, the log was longer before the erase.
+                activation_log_.push_back(active_arena_info_);
+            }
+        }
+
+        // Frees every allocation at once. Every arena goes back to the free list, large objects go back to upstream
+        // or to the cache. Memory allocated from the resource must not be used or deallocated afterwards.
+        // Every mark is invalid afterwards.
+        void Reset() noexcept
+        {
+            std::lock_guard lock(mutex_);
+
+            CollectRemoteFrees();
+
+            ReleaseFallbackBlocks();
+
+            while (large_object_list_ != nullptr)
+            {
+                auto *large_object = large_object_list_;
+                DeallocateLargeObject((std::byte *)large_object + LARGE_OBJECT_HEADER_SIZE, large_object->bytes, large_object->block_alignment);
+            }
+
+            // Backwards, because arenas above the high-water mark are removed from the map.
+            for (auto i = arena_info_map_.size(); i-- > 0;)
+            {
+                auto *arena = arena_info_map_[i];
+                if (IsActive(arena) || arena->num_of_allocation != 0)
+                {
+                    ResetArena(arena);
+                }
+            }
+
+            num_of_marks_ = 0;
+            activation_log_.clear();
+            assert(!HasTails()); // Every full arena is reset
+
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.live_bytes = 0;
+            }
+        }
+
+        // Like `RewindTo`, but the arenas and large objects used since `mark` are handed to the returned handle
+        // instead of freed. The objects stay valid until the handle is released, see `Adopt`.
+        // Arenas of the `lazy_arenas` reservation cannot be detached, `std::logic_error` is thrown if one was used
+        // since `mark` and nothing changes. Otherwise `mark` and every later mark are invalid afterwards.
+        ArenaHandle Detach(ArenaMark const &mark);
+
+        // Takes over the arenas and large objects of `handle`. They are freed like the allocations of this resource:
+        // objects of the batch may be deallocated one by one, and if marks are outstanding, the innermost
+        // `RewindTo` frees them at once. Requires the same size per arena and layout and an equal upstream.
+        void Adopt(ArenaHandle &&handle);
+
+        // Drains the frees queued by other threads. Only the owner thread may call it.
+        // Returns the number of drained frees.
+        std::size_t Collect() noexcept
+        {
+            static_assert(RemoteFreePolicy::ENABLED, "Requires RemoteFreeQueue");
+
+            std::lock_guard lock(mutex_);
+            return CollectRemoteFrees();
+        }
+
+        // Makes the calling thread the owner, by default it is the thread which constructs the resource.
+        // No other thread may use the resource meanwhile.
+        void SetOwner() noexcept
+        {
+            owner_ = std::this_thread::get_id();
+        }
+
+        // Occupancy of every arena, in the order of the arena map. O(number of arenas).
+        std::vector<ArenaSnapshot> Snapshot() const
+        {
+            std::lock_guard lock(mutex_);
+
+            auto decommitted = DecommittedArenas();
+
+            std::vector<ArenaSnapshot> snapshot;
+            snapshot.reserve(arena_info_map_.size());
+            for (auto const *arena : arena_info_map_)
+            {
+                snapshot.push_back(ArenaSnapshot{arena, StateOf(arena, decommitted), arena->Capacity(), arena->num_of_allocation,
+                                                 arena->bytes_left, arena->alignment_padding, arena->live_bytes});
+            }
+            return snapshot;
+        }
+
+        // Classifies the memory held from upstream. A full arena with at most `pinned_threshold` live allocations
+        // is pinned. O(number of arenas).
+        FragmentationReport Fragmentation(std::size_t pinned_threshold = 2) const
+        {
+            std::lock_guard lock(mutex_);
+
+            auto decommitted = DecommittedArenas();
+
+            FragmentationReport report;
+            report.num_of_arenas = arena_info_map_.size();
+
+            for (auto const *arena : arena_info_map_)
+            {
+                report.capacity += arena->Capacity();
+                report.alignment_padding += arena->alignment_padding;
+
+                switch (StateOf(arena, decommitted))
+                {
+                case ArenaState::Active:
+                    report.active_arenas += 1;
+                    report.used_bytes += arena->Capacity() - arena->bytes_left;
+                    break;
+                case ArenaState::Full:
+                    report.full_arenas += 1;
+                    report.used_bytes += arena->Capacity() - arena->bytes_left;
+                    report.tail_waste += arena->bytes_left;
+                    if (arena->num_of_allocation <= pinned_threshold)
+                    {
+                        report.pinned_arenas += 1;
+                        report.pinned_bytes += arena->Capacity();
+                        report.pinned_allocations += arena->num_of_allocation;
+                    }
+                    break;
+                case ArenaState::Free:
+                    report.free_arenas += 1;
+                    report.free_bytes += arena->Capacity();
+                    break;
+                case ArenaState::Decommitted:
+                    report.decommitted_arenas += 1;
+                    report.free_bytes += arena->Capacity();
+                    break;
+                }
+            }
+
+            report.large_objects = stats_.large_objects;
+            report.large_object_bytes = large_object_bytes_;
+            for (auto const *cached : large_object_cache_)
+            {
+                report.cached_large_object_bytes += cached->block_size;
+            }
+            return report;
+        }
+
+        // Blocks until the background prefault is done.
+        void WaitForPrefault() noexcept
+        {
+            if (prefault_thread_.joinable())
+                prefault_thread_.join();
+        }
+
+        // Counters are kept up to date by allocations, reading them is O(1).
+        ArenaStats Stats() const noexcept
+        {
+            std::lock_guard lock(mutex_);
+
+            auto stats = stats_;
+            stats.num_of_arenas = arena_info_map_.size();
+            stats.upstream_bytes = upstream_bytes_;
+            return stats;
+        }
+
+        // Current number of arenas
+        std::size_t CurrentNumOfArenas() const noexcept
+        {
+            return arena_info_map_.size();
+        }
+
+        // Initial value for number of arenas
+        std::size_t NumOfArenas() const noexcept
+        {
+            return num_of_arenas_;
+        }
+
+        // Initial value for size per arena
+        std::size_t SizePerArena() const noexcept
+        {
+            if constexpr (ArenaSizePolicy::VALUE != 0)
+                return ArenaSizePolicy::VALUE;
+            else
+                return size_per_arena_;
+        }
+
+        // Test Function
+        // Capacity of the next arena which is allocated because the pool is exhausted
+        std::size_t NextArenaCapacity() const noexcept
+        {
+            return NextArenaCapacity(0);
+        }
+
+        ArenaOptions const &Options() const noexcept
+        {
+            return options_;
+        }
+
+        // Test Function
+        // Number of free arenas
+        std::size_t FreeArenaSize() const noexcept
+        {
+            return free_arena_list_.size();
+        }
+
+        // Test Function
+        // Memory used by the user.
+        // Can be greater than user allocated space because of the alignment.
+        std::size_t UsedMemory() const noexcept
+        {
+            std::size_t total_allocated_bytes = 0;
+            for (auto const *info : arena_info_map_)
+            {
+                total_allocated_bytes += info->Capacity() - info->bytes_left;
+            }
+            return total_allocated_bytes + large_object_bytes_;
+        }
+
+        // Test Function
+        // Unused bytes at the end of full arenas, `ArenaStats::tail_waste`. They cannot be used until the arena is free.
+        // Unlike the scan of earlier versions, the active arenas of the lifetime and alignment classes are not counted
+        // and tail reuse lowers it. O(1) if statistics are enabled, else O(number of arenas).
+        std::size_t WastedMemory() const noexcept
+        {
+            if constexpr (ENABLE_STATS)
+                return stats_.tail_waste;
+
+            std::size_t wasted_bytes = 0;
+            for (auto const *info : arena_info_map_)
+            {
+                // Arenas which are not active are free once their allocations are freed
+                if (info->num_of_allocation != 0 && !IsActive(info))
+                    wasted_bytes += info->bytes_left;
+            }
+            return wasted_bytes;
+        }
+
+    private:
+        static ArenaOptions WithLayout(ArenaOptions options) noexcept
+        {
+            if constexpr (!LayoutPolicy::RUNTIME)
+                options.aligned_arenas = LayoutPolicy::ALIGNED;
+            return options;
+        }
+
+        // Without `ExtendedFeatures` the options of the extended features must keep their defaults, otherwise they are ignored.
+        static ArenaOptions WithFeatures(ArenaOptions options) noexcept
+        {
+            if constexpr (!FeaturePolicy::EXTENDED)
+            {
+                options.cache_line_padding = 0;
+                options.dedicated_alignment = 0;
+                options.lifetime_classes = 1;
+                options.tail_reuse = 0;
+                options.fallback = nullptr;
+            }
+            return options;
+        }
+
+        bool IsAligned() const noexcept
+        {
+            if constexpr (LayoutPolicy::RUNTIME)
+                return options_.aligned_arenas;
+            else
+                return LayoutPolicy::ALIGNED;
+        }
+
+        // Usable bytes of a regular arena
+        std::size_t ArenaCapacity() const noexcept
+        {
+            return IsAligned() ? SizePerArena() - ARENA_HEADER_SIZE : SizePerArena();
+        }
+
+        std::size_t ArenaAlignment() const noexcept
+        {
+            return IsAligned() ? SizePerArena() : alignof(std::max_align_t);
+        }
+
+        // Bytes an empty arena must have to fit the request whatever the alignment of its beginning is.
+        static std::size_t MaxBytesNeeded(std::size_t bytes, std::size_t alignment) noexcept
+        {
+            auto max_padding = alignment > alignof(std::max_align_t) ? alignment - alignof(std::max_align_t) : 0;
+            return bytes + max_padding;
+        }
+
+        // True if the request may not fit into the largest arena.
+        bool IsOversized(std::size_t bytes, std::size_t alignment) const noexcept
+        {
+            return MaxBytesNeeded(bytes, alignment) > max_tier_capacity_;
+        }
+
+        // Capacity of the largest tier, `ArenaCapacity()` without `size_tiers`.
+        std::size_t MaxTierCapacity() const noexcept
+        {
+            auto capacity = ArenaCapacity();
+            if (options_.size_tiers)
+            {
+                for (std::size_t tier = 1; tier < NUM_OF_TIERS && capacity <= options_.max_size_per_arena / 2; ++tier)
+                {
+                    capacity *= 2;
+                }
+            }
+            return capacity;
+        }
+
+        // Smallest tier which fits `min_capacity` and `TIER_REQUESTS_PER_ARENA` of the 90th percentile of recent
+        // misses. The percentile is capped by the largest recent miss, so tiers follow the request sizes rather
+        // than the bucket bounds.
+        std::size_t TierCapacity(std::size_t min_capacity) const noexcept
+        {
+            auto wanted = min_capacity;
+
+            if (num_of_misses_ != 0)
+            {
+                std::size_t count = 0;
+                std::size_t bucket = 0;
+                for (; bucket < miss_histogram_.size(); ++bucket)
+                {
+                    count += miss_histogram_[bucket];
+                    if (count * 10 >= num_of_misses_ * 9)
+                        break;
+                }
+
+                auto typical = std::min(std::size_t{1} << bucket, largest_miss_);
+                wanted = std::max(wanted, typical * TIER_REQUESTS_PER_ARENA);
+            }
+
+            auto capacity = ArenaCapacity();
+            while (capacity < wanted && capacity < max_tier_capacity_)
+            {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+
+        // Misses bound the tail waste, a retired arena has less space left than the request which missed.
+        void RecordMiss(std::size_t bytes) noexcept
+        {
+            miss_histogram_[detail::BitWidth(bytes - 1)] += 1;
+            num_of_misses_ += 1;
+            largest_miss_ = std::max(largest_miss_, bytes);
+
+            // Forget old misses so tiers follow the shifting request sizes.
+            if (num_of_misses_ == MISS_HISTORY)
+            {
+                num_of_misses_ = 0;
+                for (auto &count : miss_histogram_)
+                {
+                    count /= 2;
+                    num_of_misses_ += count;
+                }
+                largest_miss_ = bytes;
+            }
+        }
+
+        // Capacity of the next arena allocated because the pool is exhausted, at least `min_capacity`
+        std::size_t NextArenaCapacity(std::size_t min_capacity) const noexcept
+        {
+            if (!options_.size_tiers)
+                return next_arena_capacity_;
+            return std::max(next_arena_capacity_, TierCapacity(min_capacity));
+        }
+
+        // Capacity of an arena allocated because the pool is exhausted. Advances the geometric growth.
+        std::size_t GrowArenaCapacity(std::size_t min_capacity) noexcept
+        {
+            auto capacity = NextArenaCapacity(min_capacity);
+
+            if (options_.growth_factor > 1)
+            {
+                auto grown = static_cast<double>(next_arena_capacity_) * options_.growth_factor;
+                next_arena_capacity_ = grown >= static_cast<double>(options_.max_size_per_arena)
+                                           ? options_.max_size_per_arena
+                                           : static_cast<std::size_t>(grown);
+                next_arena_capacity_ &= ~(alignof(std::max_align_t) - 1);
+            }
+            return capacity;
+        }
+
+        ArenaInfo *AllocateArena(std::size_t capacity)
+        {
+            auto arena_size = ARENA_HEADER_SIZE + capacity;
+            if (!FitsBudget(arena_size))
+                throw std::bad_alloc();
+
+            auto *arena = (std::byte *)upstream_->allocate(arena_size, ArenaAlignment());
+            CountUpstreamAllocation(arena_size);
+            return AddArena(new (arena) ArenaInfo(0, capacity, arena + ARENA_HEADER_SIZE));
+        }
+
+        // Sets up the next arena of the reservation.
+        ArenaInfo *MaterializeArena()
+        {
+            auto *arena = reservation_ + num_of_materialized_arenas_ * (ARENA_HEADER_SIZE + ArenaCapacity());
+            num_of_materialized_arenas_ += 1;
+            return AddArena(new (arena) ArenaInfo(0, ArenaCapacity(), arena + ARENA_HEADER_SIZE));
+        }
+
+        std::pmr::memory_resource *BookkeepingResource() const noexcept
+        {
+            return options_.bookkeeping != nullptr ? options_.bookkeeping : upstream_;
+        }
+
+        // Arenas of the reservation cannot be given back one by one.
+        bool IsReserved(ArenaInfo const *arena) const noexcept
+        {
+            auto const *p = reinterpret_cast<std::byte const *>(arena);
+            return reservation_ != nullptr && p >= reservation_ && p < reservation_ + reservation_size_;
+        }
+
+        // Adds the arena to the map and to the free list.
+        ArenaInfo *AddArena(ArenaInfo *arena_info)
+        {
+            InsertArena(arena_info);
+
+            // Every arena can be in the free list at the same time. Deallocation must not cause allocation.
+            free_arena_list_.reserve(arena_info_map_.size());
+            free_arena_list_.push_back(arena_info);
+
+            return arena_info;
+        }
+
+        void InsertArena(ArenaInfo *arena_info)
+        {
+            if (IsAligned())
+            {
+                // Map is only used to iterate over the arenas. There is no need to keep it sorted.
+                arena_info_map_.push_back(arena_info);
+            }
+            else
+            {
+                // Insert to already sorted array and keep it sorted
+
+                auto insert_it = std::upper_bound(arena_info_map_.begin(), arena_info_map_.end(), arena_info,
+                                                  [](ArenaInfo const *info1, ArenaInfo const *info2)
+                                                  { return info1 < info2; });
+
+                arena_info_map_.insert(insert_it, arena_info);
+
+                assert(true == std::is_sorted(arena_info_map_.begin(), arena_info_map_.end()));
+            }
+        }
+
+        void DeallocateArena(ArenaInfo *arena) noexcept
+        {
+            if (IsReserved(arena))
+            {
+                // Given back with the reservation
+                arena->~ArenaInfo();
+                return;
+            }
+
+            auto arena_size = ARENA_HEADER_SIZE + arena->Capacity();
+            arena->~ArenaInfo();
+            upstream_->deallocate(arena, arena_size, ArenaAlignment());
+            CountUpstreamDeallocation(arena_size);
+        }
+
+        void CountUpstreamAllocation(std::size_t bytes) noexcept
+        {
+            upstream_bytes_ += bytes;
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.upstream_allocations += 1;
+                stats_.peak_upstream_bytes = std::max(stats_.peak_upstream_bytes, upstream_bytes_);
+            }
+            CheckSoftLimit();
+        }
+
+        void CountUpstreamDeallocation(std::size_t bytes) noexcept
+        {
+            upstream_bytes_ -= bytes;
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.upstream_deallocations += 1;
+            }
+
+            if (upstream_bytes_ <= options_.soft_limit)
+                above_soft_limit_ = false;
+        }
+
+        // Committed arenas are preferred. Decommitted ones are at the front of the list.
+        // Committed arenas are preferred. Such an arena must exist, see `HasFreeArena`.
+        ArenaInfo *PopFreeArena(std::size_t min_capacity = 0) noexcept
+        {
+            auto index = free_arena_list_.size() - 1;
+            while (free_arena_list_[index]->Capacity() < min_capacity)
+            {
+                index -= 1;
+            }
+
+            if (index < num_of_decommitted_arenas_)
+            {
+                // Keep decommitted arenas in front of the committed ones.
+                num_of_decommitted_arenas_ -= 1;
+                std::swap(free_arena_list_[index], free_arena_list_[num_of_decommitted_arenas_]);
+                index = num_of_decommitted_arenas_;
+            }
+
+            std::swap(free_arena_list_[index], free_arena_list_.back());
+
+            auto *arena = free_arena_list_.back();
+            free_arena_list_.pop_back();
+            return arena;
+        }
+
+        // Arenas of different sizes only exist with adaptive sizing, otherwise every free arena fits.
+        bool HasFreeArena(std::size_t min_capacity) const noexcept
+        {
+            return std::any_of(free_arena_list_.rbegin(), free_arena_list_.rend(),
+                               [min_capacity](ArenaInfo const *info)
+                               { return info->Capacity() >= min_capacity; });
+        }
+
+        // This cannot cause allocation because capacity is reserved in `AllocateArena`.
+        void PushFreeArena(ArenaInfo *arena) noexcept
+        {
+            free_arena_list_.push_back(arena);
+
+            if (options_.decommit != nullptr && free_arena_list_.size() - num_of_decommitted_arenas_ > options_.committed_free_arenas)
+            {
+                options_.decommit(arena->Begin(), arena->Capacity());
+
+                // Keep decommitted arenas in front of the committed ones.
+                std::swap(free_arena_list_[num_of_decommitted_arenas_], free_arena_list_.back());
+                num_of_decommitted_arenas_ += 1;
+            }
+        }
+
+        void *AllocateLargeObject(std::size_t bytes, std::size_t alignment)
+        {
+            if constexpr (!LargeObjectPolicy::TRACKED)
+            {
+                if (!FitsBudget(bytes))
+                    return AllocateFallback(bytes, alignment);
+
+                auto *p = upstream_->allocate(bytes, alignment);
+                CountUpstreamAllocation(bytes);
+                CountLargeObject(bytes);
+                return p;
+            }
+
+            auto block_alignment = std::max(alignment, alignof(std::max_align_t));
+            auto header_size = (LARGE_OBJECT_HEADER_SIZE + block_alignment - 1) & ~(block_alignment - 1);
+            auto block_size = header_size + bytes;
+
+            std::byte *block = nullptr;
+
+            // Most recently cached first. Do not waste a block which is more than twice as big as needed.
+            for (auto it = large_object_cache_.rbegin(); it != large_object_cache_.rend(); ++it)
+            {
+                auto *cached = *it;
+                if (cached->block_size >= block_size && cached->block_size / 2 <= block_size &&
+                    reinterpret_cast<std::uintptr_t>(cached->block) % block_alignment == 0)
+                {
+                    block = cached->block;
+                    block_size = cached->block_size;
+                    block_alignment = cached->block_alignment;
+                    large_object_cache_.erase(std::next(it).base());
+                    break;
+                }
+            }
+
+            if (block == nullptr)
+            {
+                if (!MakeRoom(block_size))
+                    return AllocateFallback(bytes, alignment);
+
+                block = (std::byte *)upstream_->allocate(block_size, block_alignment);
+                CountUpstreamAllocation(block_size);
+            }
+
+            CountLargeObject(bytes);
+
+            auto *user_ptr = block + header_size;
+            auto *large_object = new (user_ptr - LARGE_OBJECT_HEADER_SIZE) LargeObjectInfo{nullptr, large_object_list_, block, block_size, block_alignment, bytes, large_object_sequence_++};
+
+            if (large_object_list_ != nullptr)
+            {
+                large_object_list_->prev = large_object;
+            }
+            large_object_list_ = large_object;
+            return user_ptr;
+        }
+
+        void CountLargeObject(std::size_t bytes) noexcept
+        {
+            large_object_bytes_ += bytes;
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.large_objects += 1;
+                stats_.large_object_allocations += 1;
+            }
+        }
+
+        // True if `bytes` more from upstream stay within `hard_limit`.
+        bool FitsBudget(std::size_t bytes) const noexcept;
+
+        // Cached large objects count against the budget, they go first.
+        bool MakeRoom(std::size_t bytes) noexcept;
+
+        // Fires once each time the budget goes above the soft limit.
+        void CheckSoftLimit() noexcept;
+
+        // Beyond the hard limit
+        void *AllocateFallback(std::size_t bytes, std::size_t alignment);
+
+        // Returns false if `p` is not a fallback block.
+        bool DeallocateFallback(void *p) noexcept;
+
+        void ReleaseFallbackBlocks() noexcept;
+
+        void DeallocateLargeObject(void *p, std::size_t bytes, std::size_t alignment) noexcept
+        {
+            large_object_bytes_ -= bytes;
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.large_objects -= 1;
+            }
+
+            if constexpr (!LargeObjectPolicy::TRACKED)
+            {
+                upstream_->deallocate(p, bytes, alignment);
+                CountUpstreamDeallocation(bytes);
+                return;
+            }
+
+            auto *large_object = reinterpret_cast<LargeObjectInfo *>((std::byte *)p - LARGE_OBJECT_HEADER_SIZE);
+
+            if (large_object->prev != nullptr)
+                large_object->prev->next = large_object->next;
+            else
+                large_object_list_ = large_object->next;
+
+            if (large_object->next != nullptr)
+                large_object->next->prev = large_object->prev;
+
+            auto *block = large_object->block;
+            auto block_size = large_object->block_size;
+            auto block_alignment = large_object->block_alignment;
+            large_object->~LargeObjectInfo();
+
+            if (large_object_cache_.size() < options_.large_object_cache)
+            {
+                // Cached blocks keep their header at the beginning of the block.
+                // This cannot cause allocation because capacity is reserved in the constructor.
+                large_object_cache_.push_back(new (block) LargeObjectInfo{nullptr, nullptr, block, block_size, block_alignment, 0, 0});
+            }
+            else
+            {
+                upstream_->deallocate(block, block_size, block_alignment);
+                CountUpstreamDeallocation(block_size);
+            }
+        }
+
+        std::size_t TrimLargeObjectCache() noexcept
+        {
+            std::size_t released_bytes = 0;
+            for (auto *cached : large_object_cache_)
+            {
+                auto block_size = cached->block_size;
+                upstream_->deallocate(cached->block, block_size, cached->block_alignment);
+                CountUpstreamDeallocation(block_size);
+                released_bytes += block_size;
+            }
+            large_object_cache_.clear();
+            return released_bytes;
+        }
+
+        // Removes the arena from the map and gives it back to upstream.
+        // The arena must not be in the free arena list.
+        void ReleaseArena(ArenaInfo *arena) noexcept
+        {
+            RemoveArena(arena);
+            DeallocateArena(arena);
+        }
+
+        // Removes the arena from the map, the log and the tails. The arena must not be in the free arena list.
+        void RemoveArena(ArenaInfo *arena) noexcept
+        {
+            if (HasTails())
+            {
+                auto tail_it = std::find(tail_arenas_.begin(), tail_arenas_.end(), arena);
+                if (tail_it != tail_arenas_.end())
+                    tail_arenas_.erase(tail_it);
+            }
+
+            // Positions in the log are kept by marks, so the entry is cleared instead of erased.
+            std::replace(activation_log_.begin(), activation_log_.end(), arena, static_cast<ArenaInfo *>(nullptr));
+
+            if (IsAligned())
+            {
+                auto arena_it = std::find(arena_info_map_.begin(), arena_info_map_.end(), arena);
+                assert(arena_it != arena_info_map_.end());
+                *arena_it = arena_info_map_.back();
+                arena_info_map_.pop_back();
+            }
+            else
+            {
+                auto arena_it = std::lower_bound(arena_info_map_.begin(), arena_info_map_.end(), arena);
+                assert(arena_it != arena_info_map_.end() && *arena_it == arena);
+                arena_info_map_.erase(arena_it);
+            }
+        }
+
+        // Gives everything back to upstream and leaves the resource empty, like a moved object.
+        void ReleaseAll() noexcept
+        {
+            WaitForPrefault();
+
+            for (auto *arena : arena_info_map_)
+            {
+                DeallocateArena(arena);
+            }
+            arena_info_map_.clear();
+            free_arena_list_.clear();
+            lifetime_arenas_.clear();
+            tail_arenas_.clear();
+            activation_log_.clear();
+            active_arena_info_ = nullptr;
+
+            if (reservation_ != nullptr)
+            {
+                upstream_->deallocate(reservation_, reservation_size_, ArenaAlignment());
+                CountUpstreamDeallocation(reservation_size_);
+                reservation_ = nullptr;
+            }
+
+            while (large_object_list_ != nullptr)
+            {
+                auto *large_object = large_object_list_;
+                large_object_list_ = large_object->next;
+                upstream_->deallocate(large_object->block, large_object->block_size, large_object->block_alignment);
+            }
+
+            TrimLargeObjectCache();
+            ReleaseFallbackBlocks();
+        }
+
+        ArenaInfo *FindArena(void *p) const noexcept
+        {
+            if (IsAligned())
+            {
+                auto arena_mask = ~(static_cast<std::uintptr_t>(ArenaAlignment()) - 1);
+                return reinterpret_cast<ArenaInfo *>(reinterpret_cast<std::uintptr_t>(p) & arena_mask);
+            }
+
+            auto arena_it = std::upper_bound(arena_info_map_.begin(), arena_info_map_.end(), p,
+                                             [](void *ptr, ArenaInfo const *info)
+                                             { return ptr < info; });
+
+            // If pointer is allocated from this allocator it should be found in the `arena_info_map_`.
+            assert(arena_it != arena_info_map_.begin());
+
+            return *std::prev(arena_it);
+        }
+
+        // Sorted, so the state of an arena is found by binary search.
+        std::vector<ArenaInfo const *> DecommittedArenas() const
+        {
+            std::vector<ArenaInfo const *> decommitted(free_arena_list_.begin(), free_arena_list_.begin() + num_of_decommitted_arenas_);
+            std::sort(decommitted.begin(), decommitted.end());
+            return decommitted;
+        }
+
+        ArenaState StateOf(ArenaInfo const *arena, std::vector<ArenaInfo const *> const &decommitted) const noexcept
+        {
+            if (IsActive(arena))
+                return ArenaState::Active;
+            if (arena->num_of_allocation != 0)
+                return ArenaState::Full;
+            if (std::binary_search(decommitted.begin(), decommitted.end(), arena))
+                return ArenaState::Decommitted;
+            return ArenaState::Free;
+        }
+
+        // Rounds the request as `cache_line_padding` and `dedicated_alignment` ask. Deallocation rounds it the same way.
+        // Returns true if the request goes to an alignment class. That is decided on the alignment of the caller,
+        // padded requests stay in class 0 where marks, `TryExtend` and tail reuse cover them.
+        bool PadRequest([[maybe_unused]] std::size_t &bytes, [[maybe_unused]] std::size_t &alignment) const noexcept;
+
+        bool IsDedicated(std::size_t alignment) const noexcept;
+
+        // Alignment classes come after the lifetime classes, one per power of two above `std::max_align_t`.
+        std::size_t AlignmentClass(std::size_t alignment) const noexcept;
+
+        std::size_t NumOfClasses() const noexcept;
+
+        // Makes the active arena of a class the active arena while it allocates. Class 0 is active anyway.
+        class ActiveClass;
+
+        // Every allocation must be able to hold a `RemoteFreeInfo` when it is freed by another thread.
+        static void AdjustRequest(std::size_t &bytes, std::size_t &alignment) noexcept
+        {
+            bytes = std::max(bytes, sizeof(RemoteFreeInfo));
+            alignment = std::max(alignment, alignof(RemoteFreeInfo));
+        }
+
+        // Treiber stack. Only pushed by other threads and emptied at once by the owner, so there is no ABA problem.
+        void PushRemoteFree(void *p, std::size_t bytes, std::size_t alignment) noexcept
+        {
+            auto *remote_free = new (p) RemoteFreeInfo{remote_free_list_.load(std::memory_order_relaxed), bytes, alignment};
+            while (!remote_free_list_.compare_exchange_weak(remote_free->next, remote_free, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        std::size_t CollectRemoteFrees() noexcept
+        {
+            if constexpr (!RemoteFreePolicy::ENABLED)
+                return 0;
+
+            assert(std::this_thread::get_id() == owner_);
+
+            auto *remote_free = remote_free_list_.exchange(nullptr, std::memory_order_acquire);
+
+            std::size_t num_of_frees = 0;
+            while (remote_free != nullptr)
+            {
+                auto *next = remote_free->next;
+                auto bytes = remote_free->bytes;
+                auto alignment = remote_free->alignment;
+                remote_free->~RemoteFreeInfo();
+
+                DoDeallocateDetails(remote_free, bytes, alignment);
+                remote_free = next;
+                num_of_frees += 1;
+            }
+
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.remote_frees += num_of_frees;
+            }
+            return num_of_frees;
+        }
+
+        void CountRequests([[maybe_unused]] std::size_t bytes, [[maybe_unused]] std::size_t count) noexcept
+        {
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.allocations += count;
+                stats_.live_bytes += count * bytes;
+                stats_.peak_live_bytes = std::max(stats_.peak_live_bytes, stats_.live_bytes);
+                stats_.size_histogram[detail::BitWidth(bytes - 1)] += count;
+            }
+        }
+
+        void CountAllocation([[maybe_unused]] ArenaInfo *arena, [[maybe_unused]] std::size_t bytes_needed, [[maybe_unused]] std::size_t bytes) noexcept
+        {
+            if constexpr (ENABLE_STATS)
+            {
+                auto padding = bytes_needed - bytes;
+                arena->alignment_padding += padding;
+                arena->live_bytes += bytes;
+                stats_.alignment_padding += padding;
+            }
+        }
+
+        // Tails are sorted by the space left. If there is no slot left, the smallest tail is dropped.
+        // This cannot cause allocation because capacity is reserved in the constructor.
+        void KeepTail(ArenaInfo *arena) noexcept;
+
+        // Best fit: the smallest tail which fits the request, including the alignment padding.
+        void *AllocateFromTail(std::size_t bytes, std::size_t alignment) noexcept;
+
+        // Retires the active arena and activates a free one of at least `min_capacity` bytes.
+        void ActivateNextArena(std::size_t min_capacity = 0)
+        {
+            if (!HasFreeArena(min_capacity))
+            {
+                AddFreeArena(min_capacity);
+            }
+
+            if (active_arena_info_->num_of_allocation == 0)
+            {
+                // Only with `size_tiers`, the request is bigger than the empty active arena. Nothing can free it
+                // once it is retired, so it goes back to the free list. An earlier log entry must not reset it.
+                std::replace(activation_log_.begin(), activation_log_.end(), active_arena_info_, static_cast<ArenaInfo *>(nullptr));
+                PushFreeArena(active_arena_info_);
+            }
+            else
+            {
+                if constexpr (ENABLE_STATS)
+                {
+                    stats_.tail_waste += active_arena_info_->bytes_left;
+                }
+
+                if constexpr (FeaturePolicy::EXTENDED)
+                {
+                    if (options_.tail_reuse != 0 && num_of_marks_ == 0 && current_lifetime_ == 0)
+                        KeepTail(active_arena_info_);
+                }
+            }
+
+            active_arena_info_ = PopFreeArena(min_capacity);
+
+            if (num_of_marks_ != 0)
+            {
+                if (current_lifetime_ == 0)
+                    activation_log_.push_back(active_arena_info_);
+                else
+                    // Not rewound, an earlier entry must not reset it.
+                    std::replace(activation_log_.begin(), activation_log_.end(), active_arena_info_, static_cast<ArenaInfo *>(nullptr));
+            }
+        }
+
+        // Adds a free arena of at least `min_capacity` bytes, from the reservation while it lasts.
+        void AddFreeArena(std::size_t min_capacity = 0)
+        {
+            if (HasReservedArena() && min_capacity <= ArenaCapacity())
+                MaterializeArena();
+            else
+                AllocateArena(GrowArenaCapacity(min_capacity));
+        }
+
+        bool HasReservedArena() const noexcept
+        {
+            return num_of_materialized_arenas_ * (ARENA_HEADER_SIZE + ArenaCapacity()) < reservation_size_;
+        }
+
+        // Active arena of any class
+        bool IsActive(ArenaInfo const *arena) const noexcept
+        {
+            if constexpr (!FeaturePolicy::EXTENDED)
+                return arena == active_arena_info_;
+
+            return arena == active_arena_info_ ||
+                   std::find(lifetime_arenas_.begin(), lifetime_arenas_.end(), arena) != lifetime_arenas_.end();
+        }
+
+        // Constants without `ExtendedFeatures`, so the checks compile away.
+        bool HasTails() const noexcept
+        {
+            if constexpr (!FeaturePolicy::EXTENDED)
+                return false;
+
+            return !tail_arenas_.empty();
+        }
+
+        bool HasFallbackBlocks() const noexcept
+        {
+            if constexpr (!FeaturePolicy::EXTENDED)
+                return false;
+
+            return !fallback_blocks_.empty();
+        }
+
+        // Frees every allocation of the arena. A full arena goes back to the free list or to upstream above the
+        // high-water mark, the active one stays active.
+        void ResetArena(ArenaInfo *arena) noexcept
+        {
+            if (HasTails())
+            {
+                auto tail_it = std::find(tail_arenas_.begin(), tail_arenas_.end(), arena);
+                if (tail_it != tail_arenas_.end())
+                    tail_arenas_.erase(tail_it);
+            }
+
+            if constexpr (ENABLE_STATS)
+            {
+                if (!IsActive(arena))
+                {
+                    // Full arena. Its tail is not wasted anymore.
+                    stats_.tail_waste -= arena->bytes_left;
+                }
+
+                stats_.alignment_padding -= arena->alignment_padding;
+                stats_.live_bytes -= arena->live_bytes;
+            }
+
+            if (!IsActive(arena) && free_arena_list_.size() >= options_.max_free_arenas && !IsReserved(arena))
+            {
+                // Above the high-water mark
+                ReleaseArena(arena);
+                return;
+            }
+
+            arena->Reset();
+
+            if (!IsActive(arena))
+            {
+                // This cannot cause allocation because we are just returning the arena back to `free_arena_list`.
+                PushFreeArena(arena);
+            }
+        }
+
+        void InitializeArenas()
+        {
+            auto arena_size = ARENA_HEADER_SIZE + ArenaCapacity();
+
+            // The initial arenas must fit into the budget
+            if (NumOfArenas() * arena_size > options_.hard_limit)
+                throw std::bad_alloc();
+
+            // Memory to prefault
+            std::vector<std::pair<void *, std::size_t>> ranges;
+
+            if (options_.lazy_arenas)
+            {
+                // One upstream call. Pages are not touched until an arena is set up.
+                reservation_size_ = NumOfArenas() * arena_size;
+                reservation_ = (std::byte *)upstream_->allocate(reservation_size_, ArenaAlignment());
+                CountUpstreamAllocation(reservation_size_);
+                ranges.emplace_back(reservation_, reservation_size_);
+
+                MaterializeArena();
+            }
+            else
+            {
+                arena_info_map_.reserve(NumOfArenas());
+                free_arena_list_.reserve(NumOfArenas());
+
+                for (size_t i = 0; i < NumOfArenas(); i++)
+                {
+                    auto *arena = (std::byte *)upstream_->allocate(arena_size, ArenaAlignment());
+                    CountUpstreamAllocation(arena_size);
+                    auto *arena_info = new (arena) ArenaInfo(0, ArenaCapacity(), arena + ARENA_HEADER_SIZE);
+                    arena_info_map_.push_back(arena_info);
+                    free_arena_list_.push_back(arena_info);
+                    ranges.emplace_back(arena_info->Begin(), arena_info->Capacity());
+                }
+
+                // Sort once instead of a sorted insert per arena
+                if (!IsAligned())
+                    std::sort(arena_info_map_.begin(), arena_info_map_.end());
+            }
+
+            if (options_.prefault != Prefault::None)
+                PrefaultRanges(std::move(ranges));
+
+            // get the first active arena
+            active_arena_info_ = PopFreeArena();
+
+            lifetime_arenas_.reserve(NumOfClasses() - 1);
+            for (std::size_t i = 1; i < NumOfClasses(); ++i)
+            {
+                if (free_arena_list_.empty())
+                    AddFreeArena();
+                lifetime_arenas_.push_back(PopFreeArena());
+            }
+        }
+
+        void PrefaultRanges(std::vector<std::pair<void *, std::size_t>> ranges)
+        {
+            // One page is populated here to find out whether `populate` is supported. With `lazy_arenas` the only
+            // range is the whole reservation, everything else is left to the thread.
+            if (options_.prefault == Prefault::Background && options_.populate != nullptr &&
+                options_.populate(ranges.front().first, std::min(ranges.front().second, PREFAULT_STRIDE)))
+            {
+                prefault_thread_ = std::thread([ranges = std::move(ranges), populate = options_.populate]
+                                               {
+                                                   for (auto const &[p, bytes] : ranges)
+                                                   {
+                                                       populate(p, bytes);
+                                                   } });
+                return;
+            }
+
+            for (auto const &[p, bytes] : ranges)
+            {
+                if (options_.populate == nullptr || !options_.populate(p, bytes))
+                    TouchPages(p, bytes);
+            }
+        }
+
+        // Writes one byte per page. Only used before the memory is handed out.
+        static void TouchPages(void *p, std::size_t bytes) noexcept
+        {
+            auto *begin = static_cast<volatile std::byte *>(p);
+            for (std::size_t i = 0; i < bytes; i += PREFAULT_STRIDE)
+            {
+                begin[i] = std::byte{0};
+            }
+        }
+
+        void *DoAllocateDetails(std::size_t bytes, std::size_t alignment)
+        {
+            assert(detail::IsPowerOf2(alignment));
+
+            auto aligned_cursor = active_arena_info_->AlignedCursor(alignment);
+            auto bytes_needed = ((std::byte *)aligned_cursor - active_arena_info_->cursor) + bytes;
+
+            if (bytes_needed > active_arena_info_->bytes_left)
+                return AllocateFromNextArena(bytes, alignment);
+
+            // Enough space in current arena.
+
+            active_arena_info_->Reduce(bytes_needed);
+            CountAllocation(active_arena_info_, bytes_needed, bytes);
+            return aligned_cursor;
+        }
+
+        // Takes as many blocks as fit into the active arena, up to `count`. Blocks are laid out as if they were
+        // allocated one by one. Returns the number of blocks.
+        std::size_t BumpBatch(std::size_t count, std::size_t bytes, std::size_t alignment, void **ptrs) noexcept
+        {
+            assert(detail::IsPowerOf2(alignment));
+
+            auto *first = static_cast<std::byte *>(active_arena_info_->AlignedCursor(alignment));
+            auto padding = static_cast<std::size_t>(first - active_arena_info_->cursor);
+
+            if (padding + bytes > active_arena_info_->bytes_left)
+                return 0;
+
+            auto stride = detail::AlignUp(bytes, alignment);
+            auto num_of_blocks = std::min(count, (active_arena_info_->bytes_left - padding - bytes) / stride + 1);
+            auto bytes_needed = padding + (num_of_blocks - 1) * stride + bytes;
+
+            for (std::size_t i = 0; i < num_of_blocks; ++i)
+            {
+                ptrs[i] = first + i * stride;
+            }
+
+            active_arena_info_->Reduce(bytes_needed, num_of_blocks);
+            CountAllocation(active_arena_info_, bytes_needed, num_of_blocks * bytes);
+            return num_of_blocks;
+        }
+
+        // Slow path, kept out of `DoAllocateDetails` so the fast path is small enough to be inlined.
+        void *AllocateFromNextArena(std::size_t bytes, std::size_t alignment)
+        {
+            if (options_.size_tiers)
+            {
+                RecordMiss(bytes);
+            }
+
+            if (HasTails() && num_of_marks_ == 0 && current_lifetime_ == 0)
+            {
+                if (auto *p = AllocateFromTail(bytes, alignment))
+                    return p;
+            }
+
+            auto min_capacity = MaxBytesNeeded(bytes, alignment);
+
+            // The pool cannot grow, the active arena stays as it is.
+            if (!HasFreeArena(min_capacity) && !(HasReservedArena() && min_capacity <= ArenaCapacity()) &&
+                !MakeRoom(ARENA_HEADER_SIZE + NextArenaCapacity(min_capacity)))
+                return AllocateFallback(bytes, alignment);
+
+            ActivateNextArena(min_capacity);
+
+            // We know that there is enough space in the current arena.
+            auto aligned_cursor = active_arena_info_->AlignedCursor(alignment);
+            auto bytes_needed = ((std::byte *)aligned_cursor - active_arena_info_->cursor) + bytes;
+
+            active_arena_info_->Reduce(bytes_needed);
+            CountAllocation(active_arena_info_, bytes_needed, bytes);
+            return aligned_cursor;
+        }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            return Allocate(bytes, alignment);
+        }
+
+        // `bytes` and `alignment` must be the same as the allocation, they decide whether `p` is a large object.
+        void do_deallocate(void *p, std::size_t bytes = 0, std::size_t alignment = alignof(std::max_align_t)) noexcept override
+        {
+            Deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+        {
+            assert(!arena_info_map_.empty()); // Access to moved object
+
+            // Views of the lifetime classes free into this resource
+            if constexpr (FeaturePolicy::EXTENDED)
+            {
+                if (auto *view = dynamic_cast<LifetimeResource<BasicArenaMR> const *>(&other))
+                    return &view->Resource() == this;
+            }
+
+            return (this == &other);
+        }
+
+    private:
+        void DoDeallocateDetails(void *p, std::size_t bytes, std::size_t alignment) noexcept
+        {
+            if constexpr (ENABLE_STATS)
+            {
+                stats_.deallocations += 1;
+                stats_.live_bytes -= bytes;
+            }
+
+            if (HasFallbackBlocks() && DeallocateFallback(p))
+                return;
+
+            if (IsOversized(bytes, alignment))
+            {
+                DeallocateLargeObject(p, bytes, alignment);
+                return;
+            }
+
+            auto *arena = FindArena(p);
+
+            assert(arena->num_of_allocation > 0); // Else double free or memory corruption
+            arena->num_of_allocation -= 1;
+
+            if constexpr (ENABLE_STATS)
+            {
+                arena->live_bytes -= bytes;
+            }
+
+            if ((std::byte *)p + bytes == arena->cursor && IsActive(arena))
+            {
+                // Most recent allocation. Rewind the cursor so the space can be used again.
+                arena->bytes_left += bytes;
+                arena->cursor = (std::byte *)p;
+            }
+
+            // Does not free the allocated arena until num_of_allocation is 0.
+
+            if (arena->num_of_allocation == 0)
+            {
+                ResetArena(arena);
+            }
+        }
+
+        static constexpr bool ENABLE_STATS = StatsPolicy::ENABLED;
+
+        static constexpr std::size_t TIER_REQUESTS_PER_ARENA = 8; // Tail waste stays below an eighth of an arena
+        static constexpr std::size_t NUM_OF_TIERS = 8;
+        static constexpr std::size_t MISS_HISTORY = 1024;
+        static constexpr std::size_t MIN_TAIL_SIZE = 64; // Smaller tails are not worth a slot
+        static constexpr std::size_t PREFAULT_STRIDE = 4096; // Smallest common page size
+
+        std::size_t num_of_arenas_;  // Number of arenas.
+        std::size_t size_per_arena_; // Size of each arena in bytes.
+
+        ArenaOptions options_;
+
+        std::pmr::memory_resource *upstream_;
+
+        // Headers of the arenas. Sorted by address unless arenas are aligned.
+        std::pmr::vector<ArenaInfo *> arena_info_map_;
+
+        std::pmr::vector<ArenaInfo *> free_arena_list_;
+        std::size_t num_of_decommitted_arenas_ = 0; // Decommitted arenas are at the front of `free_arena_list_`
+
+        LargeObjectInfo *large_object_list_ = nullptr; // Live large objects
+        std::size_t large_object_bytes_ = 0;
+
+        std::pmr::vector<LargeObjectInfo *> large_object_cache_; // Freed large objects kept for reuse
+
+        ArenaStats stats_;
+        std::size_t upstream_bytes_ = 0; // Budget of the limits, kept without statistics too
+
+        std::size_t next_arena_capacity_; // Geometric growth of the arenas allocated on demand
+
+        // Bucket i counts the misses of (2^(i-1), 2^i] bytes. Only kept with `size_tiers`.
+        std::array<std::size_t, sizeof(std::size_t) * 8 + 1> miss_histogram_{};
+        std::size_t num_of_misses_ = 0;
+        std::size_t largest_miss_ = 0; // Since the histogram was last halved
+
+        std::size_t max_tier_capacity_; // Requests which may not fit into it are large objects
+
+        ArenaInfo *active_arena_info_;
+
+        // Single upstream allocation of the initial arenas with `lazy_arenas`
+        std::byte *reservation_ = nullptr;
+        std::size_t reservation_size_ = 0;
+        std::size_t num_of_materialized_arenas_ = 0;
+
+        std::thread prefault_thread_;
+
+        // Active arenas of the lifetime classes after class 0, then of the alignment classes
+        std::pmr::vector<ArenaInfo *> lifetime_arenas_;
+        std::size_t current_lifetime_ = 0; // Class which allocates at the moment
+
+        bool above_soft_limit_ = false;
+
+        struct FallbackBlock
+        {
+            std::size_t bytes;
+            std::size_t alignment;
+        };
+        std::pmr::unordered_map<void *, FallbackBlock> fallback_blocks_; // Live blocks of `ArenaOptions::fallback`
+
+        std::pmr::vector<ArenaInfo *> tail_arenas_; // Full arenas kept for `tail_reuse`, sorted by the space left
+
+        // Arenas activated while marks are outstanding, in activation order
+        std::pmr::vector<ArenaInfo *> activation_log_;
+        std::size_t num_of_marks_ = 0;
+        std::size_t large_object_sequence_ = 0; // Given to the next large object, objects before a mark have less
+
+        mutable typename LockPolicy::Mutex mutex_;
+
+        // Only used with `RemoteFreeQueue`
+        std::thread::id owner_ = std::this_thread::get_id();
+        std::atomic<RemoteFreeInfo *> remote_free_list_ = nullptr;
+
+    }; // BasicArenaMR
+
+    // A non-thread-safe memory resource that manages pools of memory.
+    using UnsynchronizedArenaMR = BasicArenaMR<>;
+
+    // Rewinds the resource to the mark taken on construction, e.g. once per request.
+    // Containers declared after the scope are destroyed before it.
+    template <typename ArenaResource>
+    class ArenaScope
+    {
+    public:
+        explicit ArenaScope(ArenaResource &arena_resource)
+            : arena_resource_(arena_resource),
+              mark_(arena_resource.Mark())
+        {
+        }
+
+        ArenaScope(ArenaScope const &) = delete;
+        ArenaScope &operator=(ArenaScope const &) = delete;
+
+        ~ArenaScope()
+        {
+            arena_resource_.RewindTo(mark_);
+        }
+
+        ArenaMark const &Mark() const noexcept
+        {
+            return mark_;
+        }
+
+    private:
+        ArenaResource &arena_resource_;
+        ArenaMark mark_;
+    };
+
+} // namespace arena_mr
+
+// Parts of `BasicArenaMR` which are only used by some of the features
+#include "ArenaMR/ArenaClasses.hpp"
+#include "ArenaMR/ArenaDetach.hpp"
+#include "ArenaMR/ArenaLimits.hpp"
 
 #endif // ARENA_MR
\ No newline at end of file
@@ -0,0 +1,162 @@
+#ifndef ARENA_NODE_POOL
+#define ARENA_NODE_POOL
+
+#include "ArenaMR/ArenaMR.hpp"
+#include "ArenaMR/SizeClassArenaMR.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <memory_resource>
+
+namespace arena_mr
+{
+    /*
+        A memory resource for node-based containers on top of an arena resource.
+
+        Small requests are rounded up to the size classes of `SizeClassArenaMR`. Each class keeps a free list of
+        nodes, which is refilled with `AllocateBatch`, so the arena resource is called once per `batch_size` nodes.
+        Freed nodes go back to the free list. When a list grows to `2 * batch_size` nodes, `batch_size` of them are
+        given back to the arena resource with `DeallocateBatch`, so the arenas behind them can become free.
+        Bigger or over-aligned requests go to the arena resource directly.
+
+        * Not thread-safe, like `std::pmr::unsynchronized_pool_resource`.
+        * Free nodes are given back on destruction and by `Trim`. Nodes in use must be freed before the arena
+          resource is destroyed or reset, like with any other allocation.
+    */
+    template <typename ArenaResource = UnsynchronizedArenaMR>
+    class ArenaNodePool : public std::pmr::memory_resource
+    {
+        using FreeLists = detail::SizeClassFreeLists;
+
+    public:
+        static constexpr std::size_t GRANULARITY = FreeLists::GRANULARITY;
+        static constexpr std::size_t MAX_NODE_SIZE = 256;
+
+        explicit ArenaNodePool(ArenaResource *arena_resource, std::size_t batch_size = 64) noexcept
+            : arena_resource_(arena_resource),
+              batch_size_(batch_size)
+        {
+            assert(arena_resource != nullptr);
+            assert(batch_size > 0);
+        }
+
+        ArenaNodePool(ArenaNodePool const &) = delete;
+        ArenaNodePool &operator=(ArenaNodePool const &) = delete;
+
+        ~ArenaNodePool()
+        {
+            Trim();
+        }
+
+        // Gives every free node back to the arena resource.
+        void Trim() noexcept
+        {
+            for (std::size_t index = 0; index < NUM_OF_CLASSES; ++index)
+            {
+                GiveBack(index, free_lists_.Size(index));
+            }
+        }
+
+        // Test Function
+        // Number of free nodes of all classes
+        std::size_t FreeNodeSize() const noexcept
+        {
+            return free_lists_.TotalSize();
+        }
+
+        ArenaResource *Resource() const noexcept
+        {
+            return arena_resource_;
+        }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            if (!IsNode(bytes, alignment))
+                return arena_resource_->Allocate(bytes, alignment);
+
+            auto index = FreeLists::Index(bytes);
+
+            if (free_lists_.Empty(index))
+                Refill(index);
+
+            return free_lists_.Pop(index);
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept override
+        {
+            if (!IsNode(bytes, alignment))
+            {
+                arena_resource_->Deallocate(p, bytes, alignment);
+                return;
+            }
+
+            auto index = FreeLists::Index(bytes);
+            free_lists_.Push(index, p);
+
+            if (free_lists_.Size(index) >= 2 * batch_size_)
+                GiveBack(index, batch_size_);
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+        {
+            return (this == &other);
+        }
+
+    private:
+        static constexpr std::size_t NUM_OF_CLASSES = MAX_NODE_SIZE / GRANULARITY;
+        static constexpr std::size_t CHUNK_SIZE = 64; // Nodes per call of `AllocateBatch` or `DeallocateBatch`
+
+        static bool IsNode(std::size_t bytes, std::size_t alignment) noexcept
+        {
+            return bytes != 0 && bytes <= MAX_NODE_SIZE && alignment <= GRANULARITY;
+        }
+
+        void Refill(std::size_t index)
+        {
+            std::array<void *, CHUNK_SIZE> nodes;
+
+            for (std::size_t num_of_nodes = 0; num_of_nodes < batch_size_;)
+            {
+                auto num_to_allocate = std::min(batch_size_ - num_of_nodes, nodes.size());
+                arena_resource_->AllocateBatch(num_to_allocate, FreeLists::BlockSize(index), GRANULARITY, nodes.data());
+
+                // Pushed from the last one, so nodes are handed out in address order
+                for (auto i = num_to_allocate; i-- > 0;)
+                {
+                    free_lists_.Push(index, nodes[i]);
+                }
+                num_of_nodes += num_to_allocate;
+            }
+        }
+
+        // Gives the most recently freed nodes back to the arena resource.
+        void GiveBack(std::size_t index, std::size_t num_of_nodes) noexcept
+        {
+            std::array<void *, CHUNK_SIZE> nodes;
+
+            while (num_of_nodes > 0)
+            {
+                auto num_to_release = std::min(num_of_nodes, nodes.size());
+                for (std::size_t i = 0; i < num_to_release; ++i)
+                {
+                    nodes[i] = free_lists_.Pop(index);
+                }
+
+                arena_resource_->DeallocateBatch(num_to_release, FreeLists::BlockSize(index), GRANULARITY, nodes.data());
+                num_of_nodes -= num_to_release;
+            }
+        }
+
+        ArenaResource *arena_resource_;
+        std::size_t batch_size_;
+
+        FreeLists free_lists_;
+
+    }; // ArenaNodePool
+
+} // namespace arena_mr
+
+#endif // ARENA_NODE_POOL
@@ -0,0 +1,185 @@
+#ifndef ARENA_POLICIES
+#define ARENA_POLICIES
+
+#include <cstddef>
+#include <mutex>
+#include <type_traits>
+
+// Counts every allocation and deallocation in `ArenaStats`. Otherwise only the slow path is counted.
+#ifndef ARENA_MR_ENABLE_STATS
+#define ARENA_MR_ENABLE_STATS 0
+#endif
+
+namespace arena_mr
+{
+    namespace detail
+    {
+        template <typename T>
+        struct Identity
+        {
+            using type = T;
+        };
+
+        // First policy of `Category` in `Policies`, `Default` if there is none.
+        template <typename Category, typename Default, typename... Policies>
+        struct SelectPolicy : Identity<Default>
+        {
+        };
+
+        template <typename Category, typename Default, typename Policy, typename... Policies>
+        struct SelectPolicy<Category, Default, Policy, Policies...>
+            : std::conditional_t<std::is_same_v<typename Policy::PolicyCategory, Category>,
+                                 Identity<Policy>,
+                                 SelectPolicy<Category, Default, Policies...>>
+        {
+        };
+
+        template <typename Category, typename Default, typename... Policies>
+        using SelectPolicyT = typename SelectPolicy<Category, Default, Policies...>::type;
+    }
+
+    // Policies of `BasicArenaMR`. The first policy of each group is the default.
+
+    struct ArenaSizePolicyTag
+    {
+    };
+    struct LockPolicyTag
+    {
+    };
+    struct StatsPolicyTag
+    {
+    };
+    struct LargeObjectPolicyTag
+    {
+    };
+    struct LayoutPolicyTag
+    {
+    };
+    struct RemoteFreePolicyTag
+    {
+    };
+    struct FeaturePolicyTag
+    {
+    };
+
+    // Size per arena is given to the constructor.
+    struct RuntimeArenaSize
+    {
+        using PolicyCategory = ArenaSizePolicyTag;
+        static constexpr std::size_t VALUE = 0;
+    };
+
+    // Size per arena is known at compile time, so capacity, alignment and size checks are constants.
+    template <std::size_t N>
+    struct FixedArenaSize
+    {
+        static_assert(N > 0 && N % alignof(std::max_align_t) == 0);
+
+        using PolicyCategory = ArenaSizePolicyTag;
+        static constexpr std::size_t VALUE = N;
+    };
+
+    struct NoLock
+    {
+        using PolicyCategory = LockPolicyTag;
+
+        struct Mutex
+        {
+            void lock() noexcept {}
+            void unlock() noexcept {}
+        };
+    };
+
+    // Every call takes one mutex. Simple, but threads contend on it. See `SynchronizedArenaMR`.
+    struct MutexLock
+    {
+        using PolicyCategory = LockPolicyTag;
+        using Mutex = std::mutex;
+    };
+
+    // Counters of `ArenaStats` stay zero, see `ArenaStats`.
+    struct NoStats
+    {
+        using PolicyCategory = StatsPolicyTag;
+        static constexpr bool ENABLED = false;
+    };
+
+    struct WithStats
+    {
+        using PolicyCategory = StatsPolicyTag;
+        static constexpr bool ENABLED = true;
+    };
+
+    using DefaultStats = std::conditional_t<ARENA_MR_ENABLE_STATS != 0, WithStats, NoStats>;
+
+    // Oversized requests get an in-band header. They are tracked, cached and given back on destruction.
+    struct TrackedLargeObjects
+    {
+        using PolicyCategory = LargeObjectPolicyTag;
+        static constexpr bool TRACKED = true;
+    };
+
+    // Oversized requests are forwarded to upstream as they are. They must be freed before the resource is destroyed.
+    struct ForwardedLargeObjects
+    {
+        using PolicyCategory = LargeObjectPolicyTag;
+        static constexpr bool TRACKED = false;
+    };
+
+    // `ArenaOptions::aligned_arenas` decides.
+    struct RuntimeLayout
+    {
+        using PolicyCategory = LayoutPolicyTag;
+        static constexpr bool RUNTIME = true;
+        static constexpr bool ALIGNED = false;
+    };
+
+    // Arena map is sorted, the arena of a pointer is found by binary search.
+    struct SortedLayout
+    {
+        using PolicyCategory = LayoutPolicyTag;
+        static constexpr bool RUNTIME = false;
+        static constexpr bool ALIGNED = false;
+    };
+
+    // Arenas are aligned to their size, the arena of a pointer is found by masking.
+    struct AlignedLayout
+    {
+        using PolicyCategory = LayoutPolicyTag;
+        static constexpr bool RUNTIME = false;
+        static constexpr bool ALIGNED = true;
+    };
+
+    // Every deallocation must come from the thread which allocates.
+    struct NoRemoteFree
+    {
+        using PolicyCategory = RemoteFreePolicyTag;
+        static constexpr bool ENABLED = false;
+    };
+
+    // Other threads may deallocate. Their frees are pushed to a lock-free queue which the owner thread drains
+    // on its next allocation or on `Collect`. Requests are rounded up to `sizeof(RemoteFreeInfo)`.
+    struct RemoteFreeQueue
+    {
+        using PolicyCategory = RemoteFreePolicyTag;
+        static constexpr bool ENABLED = true;
+    };
+
+    // Only the core of the resource. `cache_line_padding`, `dedicated_alignment`, `lifetime_classes`, `tail_reuse` and
+    // `fallback` keep their defaults, so allocation and deallocation never check them.
+    struct CoreFeatures
+    {
+        using PolicyCategory = FeaturePolicyTag;
+        static constexpr bool EXTENDED = false;
+    };
+
+    // Every option of `ArenaOptions` is available and checked at runtime.
+    struct ExtendedFeatures
+    {
+        using PolicyCategory = FeaturePolicyTag;
+        static constexpr bool EXTENDED = true;
+    };
+
+} // namespace arena_mr
+
+#endif // ARENA_POLICIES
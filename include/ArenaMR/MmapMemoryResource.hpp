@@ -0,0 +1,203 @@
+#ifndef MMAP_MEMORY_RESOURCE
+#define MMAP_MEMORY_RESOURCE
+
+#if !defined(__linux__)
+#error "MmapMemoryResource is only available on Linux"
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace arena_mr
+{
+    enum class HugePages
+    {
+        None,
+        Transparent, // madvise(MADV_HUGEPAGE), the kernel decides
+        Explicit     // MAP_HUGETLB, falls back to transparent huge pages if the huge page pool is empty
+    };
+
+    struct MmapOptions
+    {
+        HugePages huge_pages = HugePages::None;
+
+        // Must match the huge page size of the system. Mappings are rounded up to this size when huge pages are used.
+        std::size_t huge_page_size = 2 * 1024 * 1024;
+
+        // Prefault pages when they are mapped (MAP_POPULATE).
+        bool populate = false;
+    };
+
+    /*
+        A memory resource which maps every allocation directly with `mmap`.
+
+        Intended as the upstream of arena resources with big arenas. Use `Decommit` or `LazyDecommit` as
+        `ArenaOptions::decommit` to give the pages of free arenas back to the OS while keeping the mapping.
+
+        * Every allocation is rounded up to the page size (or huge page size) and costs at least one syscall.
+        * Thread-safe.
+    */
+    class MmapMemoryResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit MmapMemoryResource(MmapOptions const &options = {}) noexcept
+            : options_(options)
+        {
+        }
+
+        MmapOptions const &Options() const noexcept
+        {
+            return options_;
+        }
+
+        // Physical pages are freed immediately. Next access gets zero-filled pages.
+        static void Decommit(void *p, std::size_t bytes) noexcept
+        {
+            Advise(p, bytes, MADV_DONTNEED);
+        }
+
+        // Physical pages are freed when the kernel needs memory. Cheaper than `Decommit` if the arena is reused soon.
+        static void LazyDecommit(void *p, std::size_t bytes) noexcept
+        {
+#ifdef MADV_FREE
+            Advise(p, bytes, MADV_FREE);
+#else
+            Advise(p, bytes, MADV_DONTNEED);
+#endif
+        }
+
+        // Faults the pages in without writing to them. Use as `ArenaOptions::populate`.
+        // Returns false if the kernel does not support it (before Linux 5.14).
+        static bool Populate(void *p, std::size_t bytes) noexcept
+        {
+#ifdef MADV_POPULATE_WRITE
+            // Pages covering [p, p + bytes), partial pages too
+            auto begin = reinterpret_cast<std::uintptr_t>(p) & ~(PageSize() - 1);
+            auto end = reinterpret_cast<std::uintptr_t>(p) + bytes;
+            return madvise(reinterpret_cast<void *>(begin), end - begin, MADV_POPULATE_WRITE) == 0;
+#else
+            (void)p;
+            (void)bytes;
+            return false;
+#endif
+        }
+
+        static std::size_t PageSize() noexcept
+        {
+            static std::size_t const page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            return page_size;
+        }
+
+    private:
+        // Only whole pages inside of [p, p + bytes) are advised.
+        static void Advise(void *p, std::size_t bytes, int advice) noexcept
+        {
+            auto begin = (reinterpret_cast<std::uintptr_t>(p) + PageSize() - 1) & ~(PageSize() - 1);
+            auto end = (reinterpret_cast<std::uintptr_t>(p) + bytes) & ~(PageSize() - 1);
+
+            if (begin < end)
+            {
+                madvise(reinterpret_cast<void *>(begin), end - begin, advice);
+            }
+        }
+
+        std::size_t Granularity() const noexcept
+        {
+            return options_.huge_pages == HugePages::None ? PageSize() : options_.huge_page_size;
+        }
+
+        std::size_t MappingSize(std::size_t bytes) const noexcept
+        {
+            return (bytes + Granularity() - 1) & ~(Granularity() - 1);
+        }
+
+        void *Map(std::size_t size, bool huge_tlb) const noexcept
+        {
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+            if (options_.populate)
+                flags |= MAP_POPULATE;
+
+#ifdef MAP_HUGETLB
+            if (huge_tlb)
+            {
+                flags |= MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+                flags |= __builtin_ctzll(options_.huge_page_size) << MAP_HUGE_SHIFT;
+#endif
+            }
+#else
+            (void)huge_tlb;
+#endif
+
+            auto *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+            return p == MAP_FAILED ? nullptr : p;
+        }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            auto size = MappingSize(bytes);
+
+            // Transparent huge pages need huge page aligned mappings.
+            auto mapping_alignment = std::max(alignment, Granularity());
+
+            void *p = nullptr;
+
+            if (options_.huge_pages == HugePages::Explicit && mapping_alignment == Granularity())
+            {
+                // Huge TLB mappings are always aligned to the huge page size.
+                p = Map(size, true);
+            }
+
+            if (p == nullptr)
+            {
+                // Map more than needed and unmap the unaligned head and the tail.
+                auto extra = mapping_alignment > PageSize() ? mapping_alignment : 0;
+                auto *raw = static_cast<std::byte *>(Map(size + extra, false));
+                if (raw == nullptr)
+                    throw std::bad_alloc();
+
+                auto aligned = (reinterpret_cast<std::uintptr_t>(raw) + mapping_alignment - 1) & ~(mapping_alignment - 1);
+                auto *begin = reinterpret_cast<std::byte *>(aligned);
+
+                if (begin != raw)
+                    munmap(raw, begin - raw);
+                if (begin + size != raw + size + extra)
+                    munmap(begin + size, (raw + size + extra) - (begin + size));
+
+                p = begin;
+
+                if (options_.huge_pages != HugePages::None)
+                    madvise(p, size, MADV_HUGEPAGE);
+            }
+
+            return p;
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, [[maybe_unused]] std::size_t alignment) noexcept override
+        {
+            munmap(p, MappingSize(bytes));
+        }
+
+        // Mappings do not depend on the resource, only on the page size.
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+        {
+            auto *other_mmap = dynamic_cast<MmapMemoryResource const *>(&other);
+            return other_mmap != nullptr && other_mmap->Granularity() == Granularity();
+        }
+
+    private:
+        MmapOptions options_;
+
+    }; // MmapMemoryResource
+
+} // namespace arena_mr
+
+#endif // MMAP_MEMORY_RESOURCE
@@ -0,0 +1,103 @@
+#ifndef OFFSET_PTR
+#define OFFSET_PTR
+
+#include <cstddef>
+#include <cstdint>
+
+namespace arena_mr
+{
+    /*
+        A pointer which stores the distance from itself to the object it points to.
+
+        Stays valid when the memory which holds both the pointer and the object is mapped at another address,
+        e.g. a `SharedSegment` attached by another process. Use it for links inside of such memory.
+
+        * Only for objects in the same mapping as the pointer. Copying it somewhere else copies the target, not the offset.
+    */
+    template <typename T>
+    class OffsetPtr
+    {
+    public:
+        using element_type = T;
+
+        OffsetPtr() noexcept = default;
+
+        OffsetPtr(std::nullptr_t) noexcept
+        {
+        }
+
+        OffsetPtr(T *p) noexcept
+        {
+            Set(p);
+        }
+
+        OffsetPtr(OffsetPtr const &other) noexcept
+        {
+            Set(other.Get());
+        }
+
+        OffsetPtr &operator=(OffsetPtr const &other) noexcept
+        {
+            Set(other.Get());
+            return *this;
+        }
+
+        OffsetPtr &operator=(T *p) noexcept
+        {
+            Set(p);
+            return *this;
+        }
+
+        T *Get() const noexcept
+        {
+            if (offset_ == NULL_OFFSET)
+                return nullptr;
+            return reinterpret_cast<T *>(reinterpret_cast<std::uintptr_t>(this) + offset_);
+        }
+
+        T &operator*() const noexcept
+        {
+            return *Get();
+        }
+
+        T *operator->() const noexcept
+        {
+            return Get();
+        }
+
+        T &operator[](std::ptrdiff_t index) const noexcept
+        {
+            return Get()[index];
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return offset_ != NULL_OFFSET;
+        }
+
+        friend bool operator==(OffsetPtr const &lhs, OffsetPtr const &rhs) noexcept
+        {
+            return lhs.Get() == rhs.Get();
+        }
+
+        friend bool operator!=(OffsetPtr const &lhs, OffsetPtr const &rhs) noexcept
+        {
+            return lhs.Get() != rhs.Get();
+        }
+
+    private:
+        // No object starts in the middle of the pointer itself. 0 is a valid offset, a node may point to itself.
+        static constexpr std::uintptr_t NULL_OFFSET = 1;
+
+        void Set(T *p) noexcept
+        {
+            offset_ = p == nullptr ? NULL_OFFSET : reinterpret_cast<std::uintptr_t>(p) - reinterpret_cast<std::uintptr_t>(this);
+        }
+
+        // Unsigned, so the distance wraps around instead of overflowing
+        std::uintptr_t offset_ = NULL_OFFSET;
+    };
+
+} // namespace arena_mr
+
+#endif // OFFSET_PTR
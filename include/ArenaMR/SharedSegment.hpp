@@ -0,0 +1,336 @@
+#ifndef SHARED_SEGMENT
+#define SHARED_SEGMENT
+
+#if !defined(__linux__)
+#error "SharedSegment is only available on Linux"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace arena_mr
+{
+    enum class SegmentBacking
+    {
+        Shm,   // shm_open, `name` like "/ingest"
+        File,  // A regular file which keeps the data after the processes exit
+        Memfd  // memfd_create, other processes attach to "/proc/<pid>/fd/<fd>" as a file
+    };
+
+    enum class SegmentAccess
+    {
+        ReadWrite,
+        ReadOnly
+    };
+
+    struct SegmentOptions
+    {
+        // Where to map a new segment. Attached segments are mapped at the address they were created at.
+        // nullptr lets the kernel choose, which usually differs between processes.
+        void *address = nullptr;
+
+        // Attach even if the creation address is taken. Only data linked by offsets (`OffsetPtr`) is usable then.
+        bool relocatable = false;
+    };
+
+    // Written once on creation. Trivially copyable, so it is read from the file before the segment is mapped.
+    struct SegmentDescriptor
+    {
+        char magic[8] = {};
+        std::uint32_t version = 0;
+        std::uint64_t size = 0;
+        std::uint64_t address = 0; // Address of the segment when it was created
+    };
+
+    // Start of every segment. Offsets are from the start of the segment.
+    struct SegmentHeader
+    {
+        static constexpr char MAGIC[8] = {'A', 'R', 'E', 'N', 'A', 'S', 'E', 'G'};
+        static constexpr std::uint32_t VERSION = 1;
+
+        SegmentDescriptor descriptor; // First, at offset 0
+        std::atomic<std::uint64_t> used{0};
+        std::atomic<std::uint64_t> root{0}; // 0 if there is no root
+    };
+
+    /*
+        A memory resource which hands out memory of a shared segment, a mapping of shared memory or of a file.
+
+        Intended as the upstream of arena resources, so their arenas and everything allocated from them live in the
+        segment. Another process attaches to the segment and reads the data in place without copying. File backed
+        segments keep the data after the processes exit and are attached again on restart.
+
+        Restart means reading the data again. An arena resource cannot be re-attached: its lists live outside of the
+        segment and the containers in it point to the resource of the process which created them. A new arena
+        resource on a segment attached read-write adds its arenas behind the used space.
+
+        * The segment is mapped at the same address in every process, so containers with raw pointers, like pmr
+          containers, can be read by other processes. Their allocator points to the resource of the process which
+          created them, so they are read-only anywhere else. Data linked by `OffsetPtr` is valid at any address.
+        * `SetRoot` publishes the object to start from, `Root` finds it.
+        * Allocation bumps an offset in the segment header and is thread- and process-safe. Deallocation does nothing,
+          the space is reused only when the segment is created again, see `ArenaOptions::bookkeeping`. Freed large
+          objects are lost too, so use arenas which fit the requests. `DeallocatedBytes` counts the lost space.
+    */
+    class SharedSegment : public std::pmr::memory_resource
+    {
+    public:
+        // Creates a new segment of `size` bytes. An existing segment or file of the same name is replaced.
+        SharedSegment(SegmentBacking backing, char const *name, std::size_t size, SegmentOptions const &options = {})
+            : name_(name),
+              backing_(backing),
+              access_(SegmentAccess::ReadWrite)
+        {
+            size_ = (std::max(size, HEADER_SIZE) + PageSize() - 1) & ~(PageSize() - 1);
+
+            fd_ = Open(O_RDWR | O_CREAT | O_TRUNC);
+            if (ftruncate(fd_, static_cast<off_t>(size_)) != 0)
+                Fail("Cannot resize segment ");
+
+            Map(options.address, options.address != nullptr);
+
+            auto *header = new (base_) SegmentHeader;
+            header->descriptor.size = size_;
+            header->descriptor.address = reinterpret_cast<std::uintptr_t>(base_);
+            header->used.store(HEADER_SIZE, std::memory_order_relaxed);
+            header->descriptor.version = SegmentHeader::VERSION;
+            std::memcpy(header->descriptor.magic, SegmentHeader::MAGIC, sizeof(header->descriptor.magic));
+        }
+
+        // Attaches to a segment created by this or another process.
+        SharedSegment(SegmentBacking backing, char const *name, SegmentAccess access, SegmentOptions const &options = {})
+            : name_(name),
+              backing_(backing),
+              access_(access)
+        {
+            fd_ = Open(access == SegmentAccess::ReadOnly ? O_RDONLY : O_RDWR);
+
+            SegmentDescriptor descriptor;
+            struct stat file_status;
+            if (pread(fd_, &descriptor, sizeof(descriptor), 0) != sizeof(descriptor) ||
+                std::memcmp(descriptor.magic, SegmentHeader::MAGIC, sizeof(descriptor.magic)) != 0 ||
+                descriptor.version != SegmentHeader::VERSION ||
+                fstat(fd_, &file_status) != 0 || static_cast<std::uint64_t>(file_status.st_size) < descriptor.size)
+            {
+                close(fd_);
+                throw std::runtime_error(std::string("Not a segment ") + name);
+            }
+
+            size_ = descriptor.size;
+            Map(reinterpret_cast<void *>(descriptor.address), !options.relocatable);
+        }
+
+        SharedSegment(SharedSegment const &) = delete;
+        SharedSegment &operator=(SharedSegment const &) = delete;
+
+        virtual ~SharedSegment()
+        {
+            munmap(base_, size_);
+            close(fd_);
+        }
+
+        // Removes the name of a segment. Processes which attached to it keep their mapping.
+        static void Remove(SegmentBacking backing, char const *name) noexcept
+        {
+            if (backing == SegmentBacking::Shm)
+                shm_unlink(name);
+            else if (backing == SegmentBacking::File)
+                unlink(name);
+        }
+
+        // Publishes the object other processes start from. It must be in the segment.
+        void SetRoot(void const *p) noexcept
+        {
+            assert(access_ == SegmentAccess::ReadWrite);
+            assert(p == nullptr || Contains(p));
+            Header()->root.store(p == nullptr ? 0 : static_cast<std::byte const *>(p) - base_, std::memory_order_release);
+        }
+
+        template <typename T>
+        T *Root() const noexcept
+        {
+            auto root = Header()->root.load(std::memory_order_acquire);
+            return root == 0 ? nullptr : reinterpret_cast<T *>(base_ + root);
+        }
+
+        // Writes the used part of a file backed segment to the disk.
+        void Sync() noexcept
+        {
+            msync(base_, Header()->used.load(std::memory_order_acquire), MS_SYNC);
+        }
+
+        bool Contains(void const *p) const noexcept
+        {
+            return p >= base_ && p < base_ + size_;
+        }
+
+        // False if the segment is relocated, raw pointers into it are not valid then.
+        bool IsAtCreationAddress() const noexcept
+        {
+            return reinterpret_cast<std::uintptr_t>(base_) == Header()->descriptor.address;
+        }
+
+        void *Base() const noexcept
+        {
+            return base_;
+        }
+
+        std::size_t Size() const noexcept
+        {
+            return size_;
+        }
+
+        std::size_t UsedBytes() const noexcept
+        {
+            return Header()->used.load(std::memory_order_relaxed);
+        }
+
+        // Bytes this process gave back with `deallocate`. They are not reused, a steady growth means the segment runs out.
+        std::size_t DeallocatedBytes() const noexcept
+        {
+            return deallocated_bytes_.load(std::memory_order_relaxed);
+        }
+
+        // To pass a memfd segment to another process
+        int Fd() const noexcept
+        {
+            return fd_;
+        }
+
+    private:
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Segment header is shared between processes");
+        static_assert(std::is_trivially_copyable_v<SegmentDescriptor> && offsetof(SegmentHeader, descriptor) == 0);
+
+        static constexpr std::size_t HEADER_SIZE = (sizeof(SegmentHeader) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+        static std::size_t PageSize() noexcept
+        {
+            static std::size_t const page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            return page_size;
+        }
+
+        [[noreturn]] void Fail(char const *what)
+        {
+            auto message = std::string(what) + name_ + ": " + std::strerror(errno);
+            if (base_ != nullptr)
+                munmap(base_, size_);
+            if (fd_ != -1)
+                close(fd_);
+            throw std::runtime_error(message);
+        }
+
+        int Open(int flags)
+        {
+            int fd = -1;
+            switch (backing_)
+            {
+            case SegmentBacking::Shm:
+                fd = shm_open(name_.c_str(), flags, 0600);
+                break;
+            case SegmentBacking::File:
+                fd = open(name_.c_str(), flags | O_CLOEXEC, 0600);
+                break;
+            case SegmentBacking::Memfd:
+                fd = (flags & O_CREAT) ? memfd_create(name_.c_str(), MFD_CLOEXEC) : open(name_.c_str(), flags | O_CLOEXEC);
+                break;
+            }
+
+            if (fd == -1)
+                Fail("Cannot open segment ");
+            return fd;
+        }
+
+        // Maps the whole segment, at `address` if it is `required`, else anywhere.
+        void Map(void *address, bool required)
+        {
+            auto protection = access_ == SegmentAccess::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+            int flags = MAP_SHARED;
+
+#ifdef MAP_FIXED_NOREPLACE
+            if (required)
+                flags |= MAP_FIXED_NOREPLACE;
+#endif
+
+            auto *p = mmap(address, size_, protection, flags, fd_, 0);
+            if (p == MAP_FAILED)
+                Fail("Cannot map segment ");
+
+            base_ = static_cast<std::byte *>(p);
+
+            // Kernels before 4.17 take the address as a hint
+            if (required && base_ != address)
+            {
+                errno = EEXIST;
+                Fail("Cannot map segment at its address ");
+            }
+        }
+
+        SegmentHeader *Header() const noexcept
+        {
+            return reinterpret_cast<SegmentHeader *>(base_);
+        }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            if (access_ == SegmentAccess::ReadOnly)
+                throw std::bad_alloc();
+
+            auto *header = Header();
+            auto used = header->used.load(std::memory_order_relaxed);
+            std::uint64_t begin;
+
+            do
+            {
+                auto address = (reinterpret_cast<std::uintptr_t>(base_) + used + alignment - 1) & ~(alignment - 1);
+                begin = address - reinterpret_cast<std::uintptr_t>(base_);
+
+                if (begin > size_ || bytes > size_ - begin)
+                    throw std::bad_alloc();
+            } while (!header->used.compare_exchange_weak(used, begin + bytes, std::memory_order_relaxed));
+
+            return base_ + begin;
+        }
+
+        void do_deallocate([[maybe_unused]] void *p, std::size_t bytes, [[maybe_unused]] std::size_t alignment) noexcept override
+        {
+            assert(Contains(p));
+            deallocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+        {
+            return (this == &other);
+        }
+
+    private:
+        std::string name_;
+        SegmentBacking backing_;
+        SegmentAccess access_;
+
+        int fd_ = -1;
+        std::byte *base_ = nullptr;
+        std::size_t size_ = 0;
+
+        std::atomic<std::size_t> deallocated_bytes_ = 0;
+
+    }; // SharedSegment
+
+} // namespace arena_mr
+
+#endif // SHARED_SEGMENT
@@ -0,0 +1,245 @@
+#ifndef SIZE_CLASS_ARENA_MR
+#define SIZE_CLASS_ARENA_MR
+
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <array>
+
+namespace arena_mr
+{
+    namespace detail
+    {
+        // Intrusive free lists of equally sized blocks, one per size class of `alignof(std::max_align_t)` bytes.
+        class SizeClassFreeLists
+        {
+        public:
+            static constexpr std::size_t GRANULARITY = alignof(std::max_align_t);
+            static constexpr std::size_t MAX_NUM_OF_CLASSES = 64;
+
+            static std::size_t Index(std::size_t bytes) noexcept
+            {
+                return (bytes + GRANULARITY - 1) / GRANULARITY - 1;
+            }
+
+            static std::size_t BlockSize(std::size_t index) noexcept
+            {
+                return (index + 1) * GRANULARITY;
+            }
+
+            bool Empty(std::size_t index) const noexcept
+            {
+                return lists_[index].head == nullptr;
+            }
+
+            std::size_t Size(std::size_t index) const noexcept
+            {
+                return lists_[index].size;
+            }
+
+            std::size_t TotalSize() const noexcept
+            {
+                std::size_t num_of_blocks = 0;
+                for (auto const &list : lists_)
+                {
+                    num_of_blocks += list.size;
+                }
+                return num_of_blocks;
+            }
+
+            void Push(std::size_t index, void *p) noexcept
+            {
+                auto &list = lists_[index];
+                list.head = new (p) FreeBlock{list.head};
+                list.size += 1;
+            }
+
+            void *Pop(std::size_t index) noexcept
+            {
+                auto &list = lists_[index];
+                auto *block = list.head;
+                list.head = block->next;
+                list.size -= 1;
+                return block;
+            }
+
+            void Clear() noexcept
+            {
+                lists_ = {};
+            }
+
+        private:
+            struct FreeBlock
+            {
+                FreeBlock *next;
+            };
+
+            struct FreeList
+            {
+                FreeBlock *head = nullptr;
+                std::size_t size = 0;
+            };
+
+            std::array<FreeList, MAX_NUM_OF_CLASSES> lists_{};
+        };
+    } // namespace detail
+
+    struct SizeClassOptions
+    {
+        // Number of blocks carved out of the upstream at once for a size class.
+        std::size_t blocks_per_slab = 64;
+
+        // Requests greater than this are forwarded to the upstream.
+        // Size classes are multiples of `alignof(std::max_align_t)` up to this value.
+        std::size_t largest_size_class = 256;
+    };
+
+    /*
+        A non-thread-safe memory resource which keeps segregated free lists per size class on top of an
+        `UnsynchronizedArenaMR`.
+
+        An arena can only be reused when every allocation in it is freed, so a single long-living node pins the
+        whole arena. This resource carves slabs of equally sized blocks out of the upstream and reuses every
+        freed block immediately for the next request of the same size class.
+
+        * Slabs are given back to the upstream on `Release` or destruction.
+        * Requests greater than `largest_size_class` or over-aligned requests are forwarded to the upstream.
+    */
+    class SizeClassArenaMR : public std::pmr::memory_resource
+    {
+    public:
+        static constexpr std::size_t SIZE_CLASS_GRANULARITY = detail::SizeClassFreeLists::GRANULARITY;
+        static constexpr std::size_t MAX_NUM_OF_SIZE_CLASSES = detail::SizeClassFreeLists::MAX_NUM_OF_CLASSES;
+
+        // `bookkeeping` holds the list of slabs, see `ArenaOptions::bookkeeping`.
+        explicit SizeClassArenaMR(std::pmr::memory_resource *upstream, SizeClassOptions const &options = {},
+                                  std::pmr::memory_resource *bookkeeping = std::pmr::get_default_resource())
+            : options_(options),
+              upstream_{upstream},
+              slabs_(bookkeeping)
+        {
+            assert(options.blocks_per_slab > 0);
+            assert(options.largest_size_class % SIZE_CLASS_GRANULARITY == 0);
+            assert(options.largest_size_class / SIZE_CLASS_GRANULARITY <= MAX_NUM_OF_SIZE_CLASSES);
+        }
+
+        SizeClassArenaMR(SizeClassArenaMR const &) = delete;
+        SizeClassArenaMR &operator=(SizeClassArenaMR const &) = delete;
+
+        virtual ~SizeClassArenaMR()
+        {
+            Release();
+        }
+
+        // Gives every slab back to the upstream. Blocks allocated from this resource must not be used afterwards.
+        void Release() noexcept
+        {
+            for (auto const &[slab, slab_size] : slabs_)
+            {
+                upstream_->deallocate(slab, slab_size, SIZE_CLASS_GRANULARITY);
+            }
+            slabs_.clear();
+            free_lists_.Clear();
+            slab_tails_ = {};
+        }
+
+        SizeClassOptions const &Options() const noexcept
+        {
+            return options_;
+        }
+
+        std::pmr::memory_resource *Upstream() const noexcept
+        {
+            return upstream_;
+        }
+
+        // Test Function
+        // Number of slabs allocated from the upstream.
+        std::size_t NumOfSlabs() const noexcept
+        {
+            return slabs_.size();
+        }
+
+    private:
+        // Uncarved part of the last slab of a size class
+        struct SlabTail
+        {
+            std::byte *cursor = nullptr;
+            std::byte *end = nullptr;
+        };
+
+        bool IsForwarded(std::size_t bytes, std::size_t alignment) const noexcept
+        {
+            return bytes > options_.largest_size_class || alignment > SIZE_CLASS_GRANULARITY;
+        }
+
+        void AllocateSlab(SlabTail &slab_tail, std::size_t block_size)
+        {
+            auto slab_size = block_size * options_.blocks_per_slab;
+            auto *slab = (std::byte *)upstream_->allocate(slab_size, SIZE_CLASS_GRANULARITY);
+            slabs_.emplace_back(slab, slab_size);
+
+            slab_tail.cursor = slab;
+            slab_tail.end = slab + slab_size;
+        }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            if (bytes == 0)
+                return nullptr;
+
+            if (IsForwarded(bytes, alignment))
+                return upstream_->allocate(bytes, alignment);
+
+            auto index = detail::SizeClassFreeLists::Index(bytes);
+
+            if (!free_lists_.Empty(index))
+                return free_lists_.Pop(index);
+
+            auto block_size = detail::SizeClassFreeLists::BlockSize(index);
+            auto &slab_tail = slab_tails_[index];
+
+            if (slab_tail.cursor == slab_tail.end)
+            {
+                AllocateSlab(slab_tail, block_size);
+            }
+
+            auto *block = slab_tail.cursor;
+            slab_tail.cursor += block_size;
+            return block;
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept override
+        {
+            if (p == nullptr)
+                return;
+
+            if (IsForwarded(bytes, alignment))
+            {
+                upstream_->deallocate(p, bytes, alignment);
+                return;
+            }
+
+            free_lists_.Push(detail::SizeClassFreeLists::Index(bytes), p);
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+        {
+            return (this == &other);
+        }
+
+    private:
+        SizeClassOptions options_;
+
+        std::pmr::memory_resource *upstream_;
+
+        detail::SizeClassFreeLists free_lists_;
+        std::array<SlabTail, MAX_NUM_OF_SIZE_CLASSES> slab_tails_{};
+
+        std::pmr::vector<std::pair<void *, std::size_t>> slabs_; // Memory taken from the upstream
+
+    }; // SizeClassArenaMR
+
+} // namespace arena_mr
+
+#endif // SIZE_CLASS_ARENA_MR
@@ -0,0 +1,448 @@
+#ifndef SYNCHRONIZED_ARENA_MR
+#define SYNCHRONIZED_ARENA_MR
+
+#include "ArenaMR/ArenaMR.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace arena_mr
+{
+    struct SynchronizedArenaInfo
+    {
+        SynchronizedArenaInfo(std::size_t capacity, std::byte *begin) noexcept
+            : bytes_left{capacity},
+              cursor{begin},
+              begin_{begin},
+              capacity_{capacity}
+        {
+        }
+
+        // Live allocations plus one reference held by the thread which uses the arena as its active arena.
+        // The arena can only be recycled when the counter reaches zero.
+        std::atomic<std::size_t> num_of_allocation = 0;
+
+        // Only touched by the owning thread while the arena is active.
+        std::size_t bytes_left = 0;
+        std::byte *cursor = nullptr;
+
+        std::size_t Capacity() const noexcept
+        {
+            return capacity_;
+        }
+
+        std::byte *Begin() const noexcept
+        {
+            return begin_;
+        }
+
+        void Reset() noexcept
+        {
+            bytes_left = capacity_;
+            cursor = begin_;
+        }
+
+        void *AlignedCursor(std::size_t alignment) noexcept
+        {
+            return detail::Align(cursor, alignment);
+        }
+
+    private:
+        std::byte *begin_ = nullptr;
+        std::size_t capacity_ = 0;
+    };
+
+    /*
+        A thread-safe memory resource that manages pools of memory.
+
+        Every thread allocates from its own active arena, so the allocation fast path is a bump of a
+        thread-local cursor and an atomic increment. A thread caches its active arenas of the last
+        `THREAD_CACHE_SIZE` resources it used, beyond that switching resources takes the lock.
+        Free arenas are shared between threads and protected by a lock. Arenas are aligned to
+        `size_per_arena` rounded up to a power of 2, so deallocation finds the arena of a pointer by
+        masking it and only takes the lock when the arena becomes free. A power of 2 wastes nothing.
+
+        * Memory can be deallocated from any thread. `bytes` and `alignment` must be the same as the
+          allocation, they decide whether the memory came from upstream directly.
+        * Requests which do not fit into an arena are passed to upstream.
+        * An arena that is active for a thread stays reserved until the thread exits, calls
+          `ReleaseThreadArena` or the resource is destroyed.
+    */
+    class SynchronizedArenaMR : public std::pmr::memory_resource
+    {
+    public:
+        static constexpr std::size_t THREAD_CACHE_SIZE = 4;
+
+        explicit SynchronizedArenaMR(std::size_t num_of_arenas, std::size_t size_per_arena, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+            : num_of_arenas_(num_of_arenas),
+              size_per_arena_(size_per_arena),
+              arena_alignment_(std::size_t{1} << detail::BitWidth(size_per_arena - 1)),
+              upstream_{upstream},
+              id_{NextResourceId()},
+              arenas_(upstream_),
+              free_arena_list_(upstream_),
+              thread_arenas_(upstream_)
+        {
+            assert(num_of_arenas > 0);
+            assert(size_per_arena % alignof(std::max_align_t) == 0);
+            assert(size_per_arena > ARENA_HEADER_SIZE);
+            InitializeArenas();
+
+            auto &registry = Registry();
+            std::lock_guard registry_lock(registry.mutex);
+            registry.resources.emplace(id_, this);
+        }
+
+        SynchronizedArenaMR(SynchronizedArenaMR const &) = delete;
+        SynchronizedArenaMR &operator=(SynchronizedArenaMR const &) = delete;
+
+        virtual ~SynchronizedArenaMR()
+        {
+            {
+                // Exiting threads must not release their arenas from here on.
+                auto &registry = Registry();
+                std::lock_guard registry_lock(registry.mutex);
+                registry.resources.erase(id_);
+            }
+
+            for (auto *arena : arenas_)
+            {
+                arena->~SynchronizedArenaInfo();
+                upstream_->deallocate(arena, SizePerArena(), arena_alignment_);
+            }
+        }
+
+        // Initial value for number of arenas
+        std::size_t NumOfArenas() const noexcept
+        {
+            return num_of_arenas_;
+        }
+
+        // Initial value for size per arena
+        std::size_t SizePerArena() const noexcept
+        {
+            return size_per_arena_;
+        }
+
+        // Test Function
+        // Number of free arenas
+        std::size_t FreeArenaSize() const
+        {
+            std::lock_guard lock(mutex_);
+            return free_arena_list_.size();
+        }
+
+        // Number of arenas currently owned by the resource.
+        std::size_t CurrentNumOfArenas() const
+        {
+            std::lock_guard lock(mutex_);
+            return arenas_.size();
+        }
+
+        // Gives the active arena of the calling thread back to the resource.
+        // Thread exit does the same. Useful for a long-living thread which is done with the resource.
+        void ReleaseThreadArena()
+        {
+            auto &cache = ThreadCache();
+
+            {
+                std::lock_guard lock(mutex_);
+                RetireThreadArena(std::this_thread::get_id());
+            }
+
+            for (auto &entry : cache.entries)
+            {
+                if (entry.resource_id == id_)
+                    entry = {};
+            }
+
+            auto &ids = cache.resource_ids;
+            ids.erase(std::remove(ids.begin(), ids.end(), id_), ids.end());
+        }
+
+    private:
+        struct ThreadArenaCache
+        {
+            struct Entry
+            {
+                std::uint64_t resource_id = 0;
+                SynchronizedArenaInfo *active = nullptr;
+            };
+
+            std::array<Entry, THREAD_CACHE_SIZE> entries{};
+            std::size_t next_victim = 0; // Replaced round robin
+
+            std::vector<std::uint64_t> resource_ids; // Resources which hold an active arena of this thread
+
+            // Gives the active arenas of the exiting thread back to the resources which still exist.
+            ~ThreadArenaCache()
+            {
+                auto &registry = Registry();
+                std::lock_guard registry_lock(registry.mutex);
+
+                for (auto id : resource_ids)
+                {
+                    auto it = registry.resources.find(id);
+                    if (it == registry.resources.end())
+                        continue;
+
+                    auto *resource = it->second;
+                    std::lock_guard lock(resource->mutex_);
+                    resource->RetireThreadArena(std::this_thread::get_id());
+                }
+            }
+        };
+
+        // Live resources by id. Locked before the mutex of a resource.
+        struct ResourceRegistry
+        {
+            std::mutex mutex;
+            std::unordered_map<std::uint64_t, SynchronizedArenaMR *> resources;
+        };
+
+        static constexpr std::size_t ARENA_HEADER_SIZE = (sizeof(SynchronizedArenaInfo) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+        // One per thread. Resource ids are never reused, so a cache entry of a destroyed resource never matches.
+        static ThreadArenaCache &ThreadCache() noexcept
+        {
+            static thread_local ThreadArenaCache cache;
+            return cache;
+        }
+
+        static ResourceRegistry &Registry() noexcept
+        {
+            static ResourceRegistry registry;
+            return registry;
+        }
+
+        static std::uint64_t NextResourceId() noexcept
+        {
+            static std::atomic<std::uint64_t> next_id = 0;
+            return ++next_id;
+        }
+
+        std::size_t ArenaCapacity() const noexcept
+        {
+            return SizePerArena() - ARENA_HEADER_SIZE;
+        }
+
+        // The header lives in-band at the beginning of the arena.
+        SynchronizedArenaInfo *FindArena(void *p) const noexcept
+        {
+            return reinterpret_cast<SynchronizedArenaInfo *>(reinterpret_cast<std::uintptr_t>(p) & ~(arena_alignment_ - 1));
+        }
+
+        // Requires the lock.
+        SynchronizedArenaInfo *AllocateArena()
+        {
+            auto *arena = (std::byte *)upstream_->allocate(SizePerArena(), arena_alignment_);
+            auto *arena_info = new (arena) SynchronizedArenaInfo(ArenaCapacity(), arena + ARENA_HEADER_SIZE);
+            arenas_.push_back(arena_info);
+
+            // Every arena can be in the free list at the same time. Deallocation must not cause allocation.
+            free_arena_list_.reserve(arenas_.size());
+
+            return arena_info;
+        }
+
+        void InitializeArenas()
+        {
+            arenas_.reserve(NumOfArenas());
+
+            for (size_t i = 0; i < NumOfArenas(); i++)
+            {
+                free_arena_list_.push_back(AllocateArena());
+            }
+        }
+
+        // Requires the lock.
+        SynchronizedArenaInfo *AcquireFreeArena()
+        {
+            if (free_arena_list_.empty())
+            {
+                free_arena_list_.push_back(AllocateArena());
+            }
+
+            auto *arena = free_arena_list_.back();
+            free_arena_list_.pop_back();
+
+            // The reference of the active arena. Keeps the arena from being recycled by other threads.
+            arena->num_of_allocation.store(1, std::memory_order_relaxed);
+            return arena;
+        }
+
+        // Requires the lock.
+        // Drops the reference of the active arena. The arena is recycled immediately if nothing lives in it.
+        void RetireArena(SynchronizedArenaInfo *arena) noexcept
+        {
+            if (arena->num_of_allocation.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                arena->Reset();
+                free_arena_list_.push_back(arena);
+            }
+        }
+
+        // Requires the lock.
+        void RetireThreadArena(std::thread::id thread_id) noexcept
+        {
+            auto it = thread_arenas_.find(thread_id);
+            if (it == thread_arenas_.end())
+                return;
+
+            RetireArena(it->second);
+            thread_arenas_.erase(it);
+        }
+
+        SynchronizedArenaInfo *&ThreadArena()
+        {
+            auto &cache = ThreadCache();
+            for (auto &entry : cache.entries)
+            {
+                if (entry.resource_id == id_)
+                    return entry.active;
+            }
+
+            // `thread_arenas_` keeps the arena of an evicted entry.
+            std::lock_guard lock(mutex_);
+
+            auto &active = thread_arenas_[std::this_thread::get_id()];
+            if (active == nullptr)
+            {
+                active = AcquireFreeArena();
+                cache.resource_ids.push_back(id_);
+            }
+
+            auto &entry = cache.entries[cache.next_victim];
+            cache.next_victim = (cache.next_victim + 1) % THREAD_CACHE_SIZE;
+            entry = {id_, active};
+            return entry.active;
+        }
+
+        // True if the request may not fit into an empty arena. Arenas are only aligned to `alignof(std::max_align_t)`
+        // behind the header.
+        bool IsOversized(std::size_t bytes, std::size_t alignment) const noexcept
+        {
+            auto max_padding = alignment > alignof(std::max_align_t) ? alignment - alignof(std::max_align_t) : 0;
+            return bytes + max_padding > ArenaCapacity();
+        }
+
+        static std::size_t UpstreamAlignment(std::size_t alignment) noexcept
+        {
+            return std::max(alignment, alignof(std::max_align_t));
+        }
+
+        void *DoAllocateDetails(std::size_t bytes, std::size_t alignment)
+        {
+            assert(detail::IsPowerOf2(alignment));
+
+            if (IsOversized(bytes, alignment))
+                return upstream_->allocate(bytes, UpstreamAlignment(alignment));
+
+            auto *&active = ThreadArena();
+
+            auto aligned_cursor = active->AlignedCursor(alignment);
+            auto bytes_needed = ((std::byte *)aligned_cursor - active->cursor) + bytes;
+
+            if (bytes_needed > active->bytes_left)
+            {
+                if (active->num_of_allocation.load(std::memory_order_acquire) == 1)
+                {
+                    // Only the reference of this thread is left. No other thread can touch the arena.
+                    active->Reset();
+                }
+
+                aligned_cursor = active->AlignedCursor(alignment);
+                bytes_needed = ((std::byte *)aligned_cursor - active->cursor) + bytes;
+
+                if (bytes_needed > active->bytes_left)
+                {
+                    std::lock_guard lock(mutex_);
+
+                    RetireArena(active);
+                    active = AcquireFreeArena();
+                    thread_arenas_[std::this_thread::get_id()] = active;
+
+                    aligned_cursor = active->AlignedCursor(alignment);
+                    bytes_needed = ((std::byte *)aligned_cursor - active->cursor) + bytes;
+                }
+            }
+
+            // Enough space in current arena.
+
+            active->bytes_left -= bytes_needed;
+            active->cursor += bytes_needed;
+            active->num_of_allocation.fetch_add(1, std::memory_order_relaxed);
+            return aligned_cursor;
+        }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            if (bytes == 0)
+                return nullptr;
+
+            return DoAllocateDetails(bytes, alignment);
+        }
+
+        // `bytes` and `alignment` must be the same as the allocation.
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept override
+        {
+            if (p == nullptr)
+                return;
+
+            if (IsOversized(bytes, alignment))
+            {
+                upstream_->deallocate(p, bytes, UpstreamAlignment(alignment));
+                return;
+            }
+
+            // Arenas are never given back before destruction, so the header stays valid without the lock.
+            auto *arena = FindArena(p);
+
+            // Does not free the allocated arena until num_of_allocation is 0.
+            // Active arenas hold an extra reference so only full arenas can reach zero here.
+
+            auto previous = arena->num_of_allocation.fetch_sub(1, std::memory_order_acq_rel);
+            assert(previous > 0); // Else double free or memory corruption
+
+            if (previous == 1)
+            {
+                std::lock_guard lock(mutex_);
+                arena->Reset();
+                free_arena_list_.push_back(arena); // Capacity is reserved in `AllocateArena`.
+            }
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+        {
+            return (this == &other);
+        }
+
+    private:
+        std::size_t num_of_arenas_;  // Number of arenas.
+        std::size_t size_per_arena_; // Size of each arena in bytes, header included.
+        std::size_t arena_alignment_; // `size_per_arena_` rounded up to a power of 2
+
+        std::pmr::memory_resource *upstream_;
+
+        std::uint64_t const id_; // Unique id to match the thread local cache.
+
+        mutable std::mutex mutex_; // Protects everything below.
+
+        std::pmr::vector<SynchronizedArenaInfo *> arenas_; // Headers of every arena
+
+        std::pmr::vector<SynchronizedArenaInfo *> free_arena_list_;
+
+        std::pmr::unordered_map<std::thread::id, SynchronizedArenaInfo *> thread_arenas_; // Active arena of each thread
+
+    }; // SynchronizedArenaMR
+
+} // namespace arena_mr
+
+#endif // SYNCHRONIZED_ARENA_MR
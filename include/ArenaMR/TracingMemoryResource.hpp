@@ -0,0 +1,203 @@
+#ifndef TRACING_MEMORY_RESOURCE
+#define TRACING_MEMORY_RESOURCE
+
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace arena_mr
+{
+    enum class TraceEvent : std::uint32_t
+    {
+        Allocate,
+        Deallocate
+    };
+
+    // Fixed size record. Trace files are a `TraceFileHeader` followed by records in native byte order.
+    struct TraceRecord
+    {
+        std::uint64_t timestamp = 0; // Nanoseconds since the resource is constructed
+        std::uint64_t object_id = 0; // Address of the allocation, unique among the live allocations
+        std::uint64_t bytes = 0;
+        std::uint32_t alignment = 0;
+        TraceEvent event = TraceEvent::Allocate;
+    };
+
+    struct TraceFileHeader
+    {
+        static constexpr char MAGIC[8] = {'A', 'R', 'E', 'N', 'A', 'T', 'R', 'C'};
+        static constexpr std::uint32_t VERSION = 1;
+
+        char magic[8] = {};
+        std::uint32_t version = 0;
+        std::uint32_t record_size = 0;
+    };
+
+    /*
+        A non-thread-safe memory resource which forwards every request to its upstream and records it to a trace file.
+
+        Records are buffered and written in blocks, so a request costs a clock read and a copy.
+        Replay the trace with `ReadTrace` to tune arena resources offline, see examples/TraceReplay.cpp.
+
+        * The trace is complete only after `Flush` or destruction.
+    */
+    class TracingMemoryResource : public std::pmr::memory_resource
+    {
+    public:
+        static constexpr std::size_t BUFFERED_RECORDS = 4096;
+
+        // Does not take the ownership of `file`.
+        explicit TracingMemoryResource(std::FILE *file, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+            : file_(file),
+              upstream_(upstream),
+              start_(std::chrono::steady_clock::now())
+        {
+            assert(file != nullptr);
+            buffer_.reserve(BUFFERED_RECORDS);
+            WriteHeader();
+        }
+
+        explicit TracingMemoryResource(char const *path, std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+            : TracingMemoryResource(OpenFile(path), upstream)
+        {
+            owns_file_ = true;
+        }
+
+        TracingMemoryResource(TracingMemoryResource const &) = delete;
+        TracingMemoryResource &operator=(TracingMemoryResource const &) = delete;
+
+        virtual ~TracingMemoryResource()
+        {
+            Flush();
+            if (owns_file_)
+                std::fclose(file_);
+        }
+
+        // Writes the buffered records to the file.
+        void Flush() noexcept
+        {
+            if (!buffer_.empty())
+            {
+                std::fwrite(buffer_.data(), sizeof(TraceRecord), buffer_.size(), file_);
+                buffer_.clear();
+            }
+            std::fflush(file_);
+        }
+
+        // Number of records written so far, including the buffered ones
+        std::size_t NumOfRecords() const noexcept
+        {
+            return num_of_records_;
+        }
+
+        std::pmr::memory_resource *Upstream() const noexcept
+        {
+            return upstream_;
+        }
+
+    private:
+        static std::FILE *OpenFile(char const *path)
+        {
+            auto *file = std::fopen(path, "wb");
+            if (file == nullptr)
+                throw std::runtime_error(std::string("Cannot open trace file ") + path);
+            return file;
+        }
+
+        void WriteHeader() noexcept
+        {
+            TraceFileHeader header;
+            std::memcpy(header.magic, TraceFileHeader::MAGIC, sizeof(header.magic));
+            header.version = TraceFileHeader::VERSION;
+            header.record_size = sizeof(TraceRecord);
+            std::fwrite(&header, sizeof(header), 1, file_);
+        }
+
+        void Record(TraceEvent event, void *p, std::size_t bytes, std::size_t alignment) noexcept
+        {
+            auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+
+            // This cannot cause allocation because capacity is reserved in the constructor.
+            buffer_.push_back(TraceRecord{static_cast<std::uint64_t>(timestamp), reinterpret_cast<std::uintptr_t>(p),
+                                          bytes, static_cast<std::uint32_t>(alignment), event});
+            num_of_records_ += 1;
+
+            if (buffer_.size() == BUFFERED_RECORDS)
+            {
+                std::fwrite(buffer_.data(), sizeof(TraceRecord), buffer_.size(), file_);
+                buffer_.clear();
+            }
+        }
+
+    protected:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            auto *p = upstream_->allocate(bytes, alignment);
+            Record(TraceEvent::Allocate, p, bytes, alignment);
+            return p;
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) noexcept override
+        {
+            Record(TraceEvent::Deallocate, p, bytes, alignment);
+            upstream_->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override
+        {
+            return (this == &other);
+        }
+
+    private:
+        std::FILE *file_;
+        bool owns_file_ = false;
+
+        std::pmr::memory_resource *upstream_;
+
+        std::chrono::steady_clock::time_point start_;
+
+        std::vector<TraceRecord> buffer_;
+        std::size_t num_of_records_ = 0;
+
+    }; // TracingMemoryResource
+
+    // Reads every record of a trace file written by `TracingMemoryResource`.
+    inline std::vector<TraceRecord> ReadTrace(char const *path)
+    {
+        auto *file = std::fopen(path, "rb");
+        if (file == nullptr)
+            throw std::runtime_error(std::string("Cannot open trace file ") + path);
+
+        TraceFileHeader header;
+        if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+            std::memcmp(header.magic, TraceFileHeader::MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != TraceFileHeader::VERSION || header.record_size != sizeof(TraceRecord))
+        {
+            std::fclose(file);
+            throw std::runtime_error(std::string("Not a trace file ") + path);
+        }
+
+        std::vector<TraceRecord> records;
+        std::size_t num_read = 0;
+        do
+        {
+            auto size = records.size();
+            records.resize(size + TracingMemoryResource::BUFFERED_RECORDS);
+            num_read = std::fread(records.data() + size, sizeof(TraceRecord), TracingMemoryResource::BUFFERED_RECORDS, file);
+            records.resize(size + num_read);
+        } while (num_read == TracingMemoryResource::BUFFERED_RECORDS);
+
+        std::fclose(file);
+        return records;
+    }
+
+} // namespace arena_mr
+
+#endif // TRACING_MEMORY_RESOURCE